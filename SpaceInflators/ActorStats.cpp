@@ -0,0 +1,140 @@
+#include "ActorStats.h"
+#include "actor.h"
+#include <atomic>
+#include <mutex>
+#include <iomanip>
+#include <cstdlib>
+#include <cstring>
+using namespace std;
+
+namespace
+{
+	const char* const ACTOR_NAMES[NUM_IMAGE_IDS] = {
+		"Player", "Nachling", "WealthyNachling", "Smallbot", "Bullet", "Torpedo",
+		"FreeShipGoodie", "EnergyGoodie", "TorpedoGoodie", "Star"
+	};
+
+	  // Heap bytes are counted from operator new and delete on any thread
+	atomic<long long> s_bytesAllocated(0);
+	atomic<long long> s_bytesFreed(0);
+	atomic<long long> s_bytesLive(0);
+	atomic<long long> s_bytesPeak(0);
+
+	mutex      s_totalsMutex;   // guards s_totals
+	ActorStats s_totals;        // every retired world
+}
+
+ActorStats::ActorStats()
+{
+	for (int id = 0; id < NUM_IMAGE_IDS; id++)
+	{
+		m_constructed[id] = m_destroyed[id] = m_lifetimeTicks[id] = 0;
+		m_live[id] = m_peakLive[id] = 0;
+	}
+}
+
+void ActorStats::created(int imageID)
+{
+	m_constructed[imageID]++;
+	if (++m_live[imageID] > m_peakLive[imageID])
+		m_peakLive[imageID] = m_live[imageID];
+}
+
+void ActorStats::destroyed(int imageID, long long ageTicks)
+{
+	m_destroyed[imageID]++;
+	m_live[imageID]--;
+	m_lifetimeTicks[imageID] += ageTicks;
+}
+
+void ActorStats::recordAlloc(size_t bytes)
+{
+	s_bytesAllocated.fetch_add(bytes, memory_order_relaxed);
+	long long live = s_bytesLive.fetch_add(bytes, memory_order_relaxed) + bytes;
+	long long peak = s_bytesPeak.load(memory_order_relaxed);
+	while (live > peak && !s_bytesPeak.compare_exchange_weak(peak, live, memory_order_relaxed))
+		;
+}
+
+void ActorStats::recordFree(size_t bytes)
+{
+	s_bytesFreed.fetch_add(bytes, memory_order_relaxed);
+	s_bytesLive.fetch_sub(bytes, memory_order_relaxed);
+}
+
+void ActorStats::merge(const ActorStats& other)
+{
+	for (int id = 0; id < NUM_IMAGE_IDS; id++)
+	{
+		m_constructed[id] += other.m_constructed[id];
+		m_destroyed[id] += other.m_destroyed[id];
+		m_lifetimeTicks[id] += other.m_lifetimeTicks[id];
+		m_live[id] += other.m_live[id];
+		if (other.m_peakLive[id] > m_peakLive[id])
+			m_peakLive[id] = other.m_peakLive[id];
+	}
+}
+
+void ActorStats::retire(const ActorStats& stats)
+{
+	lock_guard<mutex> lock(s_totalsMutex);
+	s_totals.merge(stats);
+}
+
+void ActorStats::writeReport(ostream& os) const
+{
+	  // The report goes to cout between other output, so leave its format as found
+	ios_base::fmtflags flags = os.flags();
+	streamsize precision = os.precision();
+	os << "Actor allocations" << endl;
+	os << "  type              constructed    destroyed   live   peak        bytes  mean life (ticks)" << endl;
+	for (int id = 0; id < NUM_IMAGE_IDS; id++)
+	{
+		if (m_constructed[id] == 0)
+			continue;
+		os << "  " << left << setw(16) << ACTOR_NAMES[id] << right
+		   << setw(13) << m_constructed[id] << setw(13) << m_destroyed[id]
+		   << setw(7) << m_live[id] << setw(7) << m_peakLive[id]
+		   << setw(13) << m_constructed[id] * (long long)(Actor::sizeOf(id)) << setw(19);
+		if (m_destroyed[id] > 0)
+			os << fixed << setprecision(1) << double(m_lifetimeTicks[id]) / m_destroyed[id];
+		else
+			os << "-";
+		os << endl;
+	}
+	os.flags(flags);
+	os.precision(precision);
+}
+
+void ActorStats::writeProcessReport(ostream& os, const ActorStats* running)
+{
+	ActorStats report;
+	{
+		lock_guard<mutex> lock(s_totalsMutex);
+		report = s_totals;
+	}
+	if (running != NULL)
+		report.merge(*running);
+	report.writeReport(os);
+	os << "  heap: " << s_bytesAllocated.load(memory_order_relaxed) << " bytes allocated, "
+	   << s_bytesFreed.load(memory_order_relaxed) << " freed, "
+	   << s_bytesLive.load(memory_order_relaxed) << " live, peak "
+	   << s_bytesPeak.load(memory_order_relaxed) << endl;
+}
+
+void ActorStats::enableReportAtExit(int* argc, char* argv[])
+{
+	if (*argc < 2 || strcmp(argv[1], "--actor-report") != 0)
+		return;
+	for (int k = 1; k + 1 < *argc; k++)
+		argv[k] = argv[k + 1];
+	(*argc)--;
+	argv[*argc] = NULL;
+	atexit(writeReportAtExit);
+}
+
+void ActorStats::writeReportAtExit()
+{
+	if (s_bytesAllocated.load(memory_order_relaxed) > 0)   // skip modes that never made an actor
+		writeProcessReport(cout, NULL);
+}
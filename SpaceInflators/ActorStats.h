@@ -0,0 +1,50 @@
+#ifndef _ACTORSTATS_H_
+#define _ACTORSTATS_H_
+
+#include "GameConstants.h"
+#include <cstddef>
+#include <iostream>
+
+// Allocation and lifetime accounting for each actor type, keyed by image
+// ID since every concrete Actor class has its own.  Each StudentWorld
+// counts its own actors with plain arithmetic and folds the counts into
+// the process-wide totals when it is destroyed, so worlds on different
+// threads never share a counter.  Heap bytes are counted separately, and
+// process-wide, by Actor's class-level operator new and delete.
+class ActorStats
+{
+  public:
+	ActorStats();
+
+	void created(int imageID);
+	void destroyed(int imageID, long long ageTicks);
+
+	void merge(const ActorStats& other);
+	void writeReport(std::ostream& os) const;   // this object's counts by type
+
+	static void recordAlloc(std::size_t bytes);
+	static void recordFree(std::size_t bytes);
+
+	  // Fold a world's counts into the process-wide totals
+	static void retire(const ActorStats& stats);
+
+	  // The process-wide totals plus heap bytes, adding the counts of a
+	  // world still running (if not NULL)
+	static void writeProcessReport(std::ostream& os, const ActorStats* running);
+
+	  // Handles "--actor-report" at the front of argv the way metricsInit
+	  // handles --metrics: removes it and prints the process-wide report to
+	  // stdout when the program exits
+	static void enableReportAtExit(int* argc, char* argv[]);
+
+  private:
+	static void writeReportAtExit();
+
+	long long m_constructed[NUM_IMAGE_IDS];
+	long long m_destroyed[NUM_IMAGE_IDS];
+	long long m_lifetimeTicks[NUM_IMAGE_IDS];   // summed over destroyed actors
+	int       m_live[NUM_IMAGE_IDS];
+	int       m_peakLive[NUM_IMAGE_IDS];        // merged as the largest of any one world
+};
+
+#endif // _ACTORSTATS_H_
@@ -0,0 +1,221 @@
+#include "AgentEnv.h"
+#include "StudentWorld.h"
+#include "GraphObject.h"
+#include "Snapshot.h"
+#include "Metrics.h"
+#include "Telemetry.h"
+#include "OfflineAudio.h"
+#include <cstring>
+
+namespace
+{
+	  // Occupancy channel for each image ID; projectiles are split by owner
+	  // instead, and stars are not actors
+	const int IMAGE_CHANNELS[NUM_IMAGE_IDS] = {
+		GRID_PLAYER, GRID_NACHLING, GRID_WEALTHY_NACHLING, GRID_SMALLBOT,
+		-1, -1,
+		GRID_FREE_SHIP_GOODIE, GRID_ENERGY_GOODIE, GRID_TORPEDO_GOODIE,
+		-1
+	};
+
+	inline unsigned char* gridCell(unsigned char grid[], int channel, int x, int y)
+	{
+		return &grid[(channel * VIEW_HEIGHT + y) * VIEW_WIDTH + x];
+	}
+
+	inline unsigned char toByte(double fraction)
+	{
+		if (fraction <= 0)
+			return 0;
+		if (fraction >= 1)
+			return 255;
+		return (unsigned char)(fraction * 255 + .5);
+	}
+}
+
+AgentEnv::AgentEnv()
+ : m_world(NULL), m_done(true), m_audio(NULL)
+{
+	GraphObject::setRegistryEnabled(false);
+}
+
+AgentEnv::~AgentEnv()
+{
+	delete m_world;
+}
+
+void AgentEnv::setAudioRenderer(OfflineAudioRenderer* renderer)
+{
+	m_audio = renderer;
+	if (m_world != NULL)
+		m_world->setAudioRenderer(renderer);
+}
+
+void AgentEnv::reset(unsigned int seed, AgentObservation& obs)
+{
+	delete m_world;
+	m_world = new StudentWorld;
+	m_world->seedRandom(seed);
+	m_world->setAudioRenderer(m_audio);
+	m_world->init();
+	m_done = false;
+	observe(obs);
+}
+
+AgentStepResult AgentEnv::step(int action, AgentObservation& obs)
+{
+	AgentStepResult result;
+	result.reward = 0;
+	result.lifeLost = false;
+	result.done = m_done;
+	if (m_done)
+	{
+		observe(obs);
+		return result;
+	}
+
+	m_world->clearInjectedKeys();
+	injectAction(m_world, action);
+
+	unsigned int scoreBefore = m_world->getScore();
+	MetricsShard* metrics = m_world->getMetrics();
+	long long moveStart = metrics != NULL ? Telemetry::now() : 0;
+	int status = m_world->move();
+	if (metrics != NULL)
+		metrics->recordTick(Telemetry::now() - moveStart);
+	if (m_audio != NULL)
+		m_audio->endTick();
+	result.reward = int(m_world->getScore() - scoreBefore);
+
+	  // Same sequence as the controller's contgame/cleanup/init states
+	if (status == GWSTATUS_PLAYER_DIED)
+	{
+		result.lifeLost = true;
+		if (m_world->isGameOver())
+			m_done = true;
+		else
+		{
+			m_world->cleanUp();
+			m_world->init();
+		}
+	}
+	result.done = m_done;
+	observe(obs);
+	return result;
+}
+
+void AgentEnv::injectAction(StudentWorld* world, int action, int player)
+{
+	static const int MOVE_KEYS[] = {
+		0, KEY_PRESS_LEFT, KEY_PRESS_RIGHT, KEY_PRESS_UP, KEY_PRESS_DOWN
+	};
+	int move = action & ACTION_MOVE_MASK;
+	if (move > 0  &&  move < sizeof(MOVE_KEYS)/sizeof(MOVE_KEYS[0]))
+		world->injectKey(MOVE_KEYS[move], player);
+	if (action & ACTION_FIRE)
+		world->injectKey(KEY_PRESS_SPACE, player);
+	else if (action & ACTION_TORPEDO)
+		world->injectKey(KEY_PRESS_TAB, player);
+}
+
+void AgentEnv::observe(AgentObservation& obs) const
+{
+	obs.playerX = obs.playerY = obs.playerEnergy = obs.torpedoes = 0;
+	obs.lives = obs.round = 0;
+	obs.score = 0;
+	obs.entities.clear();
+	if (m_world == NULL)
+		return;
+
+	obs.lives = m_world->getLives();
+	obs.round = m_world->getRound();
+	obs.score = m_world->getScore();
+	const Player* player = m_world->getPlayer();
+	if (player != NULL)
+	{
+		obs.playerX = player->getX();
+		obs.playerY = player->getY();
+		obs.playerEnergy = int(player->getEnergyPct() * 100);
+		obs.torpedoes = player->getNumTorpedoes();
+	}
+
+	const std::vector<Actor*>& actors = m_world->getActors();
+	for (size_t k = 0; k < actors.size(); k++)
+	{
+		const Actor* a = actors[k];
+		int id = a->getID();
+		bool playerFired = (id == IID_BULLET || id == IID_TORPEDO) && static_cast<const Projectile*>(a)->playerFired();
+		AgentEntity e = { id, a->getX(), a->getY(), playerFired };
+		obs.entities.push_back(e);
+	}
+}
+
+void AgentEnv::observeGrid(unsigned char grid[]) const
+{
+	memset(grid, 0, GRID_SIZE);
+	if (m_world == NULL)
+		return;
+
+	const Player* player = m_world->getPlayer();
+	if (player != NULL)
+	{
+		*gridCell(grid, GRID_PLAYER, player->getX(), player->getY()) = 255;
+		*gridCell(grid, GRID_ENERGY, player->getX(), player->getY()) = toByte(player->getEnergyPct());
+	}
+
+	const std::vector<Actor*>& actors = m_world->getActors();
+	for (size_t k = 0; k < actors.size(); k++)
+	{
+		const Actor* a = actors[k];
+		int x = a->getX(), y = a->getY();
+		if (x < 0 || x >= VIEW_WIDTH || y < 0 || y >= VIEW_HEIGHT)
+			continue;
+		int id = a->getID();
+		switch (id)
+		{
+			case IID_BULLET:
+			case IID_TORPEDO:
+				  // The image ID says which class it is, so no dynamic_cast is needed
+				*gridCell(grid, static_cast<const Projectile*>(a)->playerFired() ?
+				          GRID_PLAYER_PROJECTILE : GRID_ALIEN_PROJECTILE, x, y) = 255;
+				break;
+			case IID_NACHLING:
+			case IID_WEALTHY_NACHLING:
+			case IID_SMALLBOT:
+				*gridCell(grid, IMAGE_CHANNELS[id], x, y) = 255;
+				*gridCell(grid, GRID_ENERGY, x, y) = toByte(static_cast<const Ship*>(a)->getEnergyPct());
+				break;
+			case IID_FREE_SHIP_GOODIE:
+			case IID_ENERGY_GOODIE:
+			case IID_TORPEDO_GOODIE:
+				*gridCell(grid, IMAGE_CHANNELS[id], x, y) = 255;
+				*gridCell(grid, GRID_BRIGHTNESS, x, y) = toByte(a->getBrightness());
+				break;
+		}
+	}
+}
+
+size_t AgentEnv::saveSnapshot(void* buffer, size_t capacity) const
+{
+	if (m_world == NULL)
+		return 0;
+	SnapshotWriter w(buffer, capacity);
+	m_world->saveState(w);
+	return w.size();
+}
+
+bool AgentEnv::restoreSnapshot(const void* buffer, size_t size)
+{
+	StudentWorld* world = new StudentWorld;
+	SnapshotReader r(buffer, size);
+	if (!world->loadState(r))
+	{
+		delete world;
+		return false;
+	}
+	delete m_world;
+	m_world = world;
+	m_world->setAudioRenderer(m_audio);
+	m_done = m_world->isGameOver();
+	return true;
+}
@@ -0,0 +1,128 @@
+#ifndef _AGENTENV_H_
+#define _AGENTENV_H_
+
+#include "GameConstants.h"
+#include <vector>
+#include <cstddef>
+
+class StudentWorld;
+class OfflineAudioRenderer;
+
+// An action is at most one move ORed with at most one shot
+const int ACTION_NONE    = 0;
+const int ACTION_LEFT    = 1;
+const int ACTION_RIGHT   = 2;
+const int ACTION_UP      = 3;
+const int ACTION_DOWN    = 4;
+const int ACTION_MOVE_MASK = 7;
+const int ACTION_FIRE    = 8;    // fire a bullet
+const int ACTION_TORPEDO = 16;   // fire a torpedo (ignored if ACTION_FIRE is also set)
+const int NUM_ACTIONS    = 24;   // every action is in [0, NUM_ACTIONS)
+
+// Channels of the grid observation, each a VIEW_HEIGHT x VIEW_WIDTH plane.
+// Occupancy channels hold 255 where such an actor is and 0 elsewhere; the
+// energy channel holds a ship's energy and the brightness channel a
+// goodie's brightness, both scaled so that full is 255.
+const int GRID_PLAYER            = 0;
+const int GRID_NACHLING          = 1;
+const int GRID_WEALTHY_NACHLING  = 2;
+const int GRID_SMALLBOT          = 3;
+const int GRID_PLAYER_PROJECTILE = 4;
+const int GRID_ALIEN_PROJECTILE  = 5;
+const int GRID_FREE_SHIP_GOODIE  = 6;
+const int GRID_ENERGY_GOODIE     = 7;
+const int GRID_TORPEDO_GOODIE    = 8;
+const int GRID_ENERGY            = 9;
+const int GRID_BRIGHTNESS        = 10;
+const int NUM_GRID_CHANNELS      = 11;
+const int GRID_SIZE = NUM_GRID_CHANNELS * VIEW_HEIGHT * VIEW_WIDTH;   // bytes
+
+struct AgentEntity
+{
+	int imageID;
+	int x;
+	int y;
+	bool playerFired;     // for bullets and torpedoes: true if the player fired it
+};
+
+struct AgentObservation
+{
+	int playerX;
+	int playerY;
+	int playerEnergy;     // percent of full
+	int torpedoes;
+	int lives;
+	int round;
+	unsigned int score;
+	std::vector<AgentEntity> entities;   // every actor but the player
+};
+
+struct AgentStepResult
+{
+	int  reward;      // score gained this step
+	bool lifeLost;    // the player died this step
+	bool done;        // the game is over; call reset() to play again
+};
+
+// Drives a StudentWorld one tick at a time with no window, input devices or
+// sound, for bots and automated play-testing.  Actions go straight to the
+// player instead of through the keyboard queue, and every world draws its
+// random numbers from its own seeded generator, so reset(seed) followed by
+// the same actions always plays out the same way.
+//
+// Creating an AgentEnv turns off the GraphObject registry: nothing an agent
+// plays is drawn, so agents and the windowed game don't share a process.
+// The caller's AgentObservation is reused from step to step, so once its
+// entity list has grown a step makes no allocations for it.
+class AgentEnv
+{
+  public:
+	AgentEnv();
+	~AgentEnv();
+
+	void reset(unsigned int seed, AgentObservation& obs);
+	AgentStepResult step(int action, AgentObservation& obs);
+	void observe(AgentObservation& obs) const;
+
+	  // Write the current state into grid[GRID_SIZE], laid out as
+	  // grid[(channel * VIEW_HEIGHT + y) * VIEW_WIDTH + x].  Nothing else is
+	  // allocated or copied; the caller can hand the buffer straight to a model.
+	void observeGrid(unsigned char grid[]) const;
+
+	  // Write the whole game into buffer[capacity] and return its size; the
+	  // buffer holds a usable snapshot only if that size is <= capacity, so
+	  // a call with no buffer tells the caller how much to allocate.
+	size_t saveSnapshot(void* buffer, size_t capacity) const;
+
+	  // Continue from a snapshot written by saveSnapshot.  If it is bad,
+	  // returns false and leaves the current game as it was.
+	bool restoreSnapshot(const void* buffer, size_t size);
+
+	  // Render every world's sounds with renderer from now on, one tick of
+	  // audio per step(); NULL (the default) drops them
+	void setAudioRenderer(OfflineAudioRenderer* renderer);
+
+	bool isDone() const
+	{
+		return m_done;
+	}
+
+	  // Queue the keys that make up action for one of world's players, as
+	  // step() does for the first
+	static void injectAction(StudentWorld* world, int action, int player = 0);
+
+	const StudentWorld* getWorld() const
+	{
+		return m_world;
+	}
+
+  private:
+	AgentEnv(const AgentEnv&);
+	AgentEnv& operator=(const AgentEnv&);
+
+	StudentWorld* m_world;
+	bool          m_done;
+	OfflineAudioRenderer* m_audio;
+};
+
+#endif // _AGENTENV_H_
@@ -0,0 +1,133 @@
+#include "AgentPolicy.h"
+#include "GameConstants.h"
+#include <cstdlib>
+using namespace std;
+
+namespace
+{
+	class IdlePolicy : public AgentPolicy
+	{
+	  public:
+		virtual int chooseAction(const AgentObservation&)
+		{
+			return ACTION_NONE;
+		}
+	};
+
+	class RandomPolicy : public AgentPolicy
+	{
+	  public:
+		RandomPolicy()
+		 : m_state(1)
+		{
+		}
+
+		virtual void reset(unsigned int seed)
+		{
+			m_state = seed;
+		}
+
+		virtual int chooseAction(const AgentObservation&)
+		{
+			m_state = m_state * 1103515245u + 12345u;
+			return int((m_state >> 16) & 0x7fff) % NUM_ACTIONS;
+		}
+
+	  private:
+		unsigned int m_state;
+	};
+
+	class SweepPolicy : public AgentPolicy
+	{
+	  public:
+		SweepPolicy()
+		 : m_right(true)
+		{
+		}
+
+		virtual void reset(unsigned int)
+		{
+			m_right = true;
+		}
+
+		virtual int chooseAction(const AgentObservation& obs)
+		{
+			if (obs.playerX == 0)
+				m_right = true;
+			else if (obs.playerX == VIEW_WIDTH-1)
+				m_right = false;
+			if (obs.playerY > 0)
+				return ACTION_DOWN | ACTION_FIRE;
+			return (m_right ? ACTION_RIGHT : ACTION_LEFT) | ACTION_FIRE;
+		}
+
+	  private:
+		bool m_right;
+	};
+
+	class HunterPolicy : public AgentPolicy
+	{
+	  public:
+		virtual int chooseAction(const AgentObservation& obs)
+		{
+			const int DANGER_ROWS = 3;   // how far above the player an alien shot is a threat
+			int px = obs.playerX, py = obs.playerY;
+			bool threatened[3] = { false, false, false };   // columns px-1, px, px+1
+			int targetX = -1, targetY = VIEW_HEIGHT, targetID = -1;
+			for (size_t k = 0; k < obs.entities.size(); k++)
+			{
+				const AgentEntity& e = obs.entities[k];
+				bool alien = (e.imageID == IID_NACHLING || e.imageID == IID_WEALTHY_NACHLING || e.imageID == IID_SMALLBOT);
+				bool shot = (e.imageID == IID_BULLET || e.imageID == IID_TORPEDO) && !e.playerFired;
+				if ((alien || shot) && abs(e.x - px) <= 1 && e.y > py && e.y - py <= DANGER_ROWS)
+					threatened[e.x - px + 1] = true;
+				if (alien && e.y > py && e.y < targetY)
+				{
+					targetX = e.x;
+					targetY = e.y;
+					targetID = e.imageID;
+				}
+			}
+
+			int action = ACTION_NONE;
+			if (threatened[1])
+			{
+				  // Step aside toward whichever neighbour is open and on the board
+				if (px > 0 && !threatened[0])
+					action = ACTION_LEFT;
+				else if (px < VIEW_WIDTH-1 && !threatened[2])
+					action = ACTION_RIGHT;
+				else
+					action = ACTION_DOWN;
+			}
+			else if (targetX >= 0 && targetX < px && !threatened[0])
+				action = ACTION_LEFT;
+			else if (targetX > px && !threatened[2])
+				action = ACTION_RIGHT;
+			else if (py > 0)
+				action = ACTION_DOWN;
+
+			if (targetX == px && targetID == IID_SMALLBOT && obs.torpedoes > 0)
+				return action | ACTION_TORPEDO;
+			return action | ACTION_FIRE;
+		}
+	};
+}
+
+AgentPolicy* createAgentPolicy(const string& name)
+{
+	if (name == "idle")
+		return new IdlePolicy;
+	if (name == "random")
+		return new RandomPolicy;
+	if (name == "sweep")
+		return new SweepPolicy;
+	if (name == "hunter")
+		return new HunterPolicy;
+	return NULL;
+}
+
+const char* agentPolicyNames()
+{
+	return "idle, random, sweep, hunter";
+}
@@ -0,0 +1,34 @@
+#ifndef _AGENTPOLICY_H_
+#define _AGENTPOLICY_H_
+
+#include "AgentEnv.h"
+#include <string>
+
+// A scripted player for AgentEnv: picks each tick's action from the current
+// observation.  Policies that use randomness draw it from a generator
+// seeded by reset(), so a policy plays a seeded game the same way every time.
+class AgentPolicy
+{
+  public:
+	virtual ~AgentPolicy()
+	{
+	}
+
+	virtual void reset(unsigned int)
+	{
+	}
+
+	virtual int chooseAction(const AgentObservation& obs) = 0;
+};
+
+// Policies by name:
+//   idle     never moves or fires
+//   random   a uniformly random action every tick
+//   sweep    sweeps the bottom row from wall to wall, firing constantly
+//   hunter   lines up under the lowest alien and fires, stepping aside from
+//            alien projectiles about to land on it; torpedoes Smallbots
+// Returns NULL for an unknown name.
+AgentPolicy* createAgentPolicy(const std::string& name);
+const char* agentPolicyNames();   // the names above, for usage messages
+
+#endif // _AGENTPOLICY_H_
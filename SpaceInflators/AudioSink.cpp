@@ -0,0 +1,142 @@
+#include "AudioSink.h"
+#include "SoundMixer.h"
+#include <iostream>
+#include <cstdio>
+#include <cstdlib>
+#ifndef _WIN32
+#include <csignal>
+#endif
+using namespace std;
+
+namespace
+{
+	void putLE(ostream& os, unsigned int v, int bytes)
+	{
+		for (int k = 0; k < bytes; k++)
+			os.put(char((v >> (8 * k)) & 0xff));
+	}
+
+	const int WAV_HEADER_BYTES = 44;
+
+	void writeWavHeader(ostream& os, unsigned int dataBytes)
+	{
+		os.write("RIFF", 4);
+		putLE(os, WAV_HEADER_BYTES - 8 + dataBytes, 4);
+		os.write("WAVEfmt ", 8);
+		putLE(os, 16, 4);                                   // fmt chunk size
+		putLE(os, 1, 2);                                    // PCM
+		putLE(os, MIXER_CHANNELS, 2);
+		putLE(os, MIXER_RATE, 4);
+		putLE(os, MIXER_RATE * MIXER_CHANNELS * 2, 4);      // bytes per second
+		putLE(os, MIXER_CHANNELS * 2, 2);                   // bytes per frame
+		putLE(os, 16, 2);                                   // bits per sample
+		os.write("data", 4);
+		putLE(os, dataBytes, 4);
+	}
+}
+
+// FileAudioSink
+
+FileAudioSink::FileAudioSink(const string& path)
+ : m_file(path.c_str(), ios::binary), m_dataBytes(0)
+{
+	if (m_file)
+		writeWavHeader(m_file, 0);   // sizes are patched on close
+}
+
+FileAudioSink::~FileAudioSink()
+{
+	if (m_file)
+	{
+		m_file.seekp(0);
+		writeWavHeader(m_file, m_dataBytes);
+	}
+}
+
+bool FileAudioSink::isOpen() const
+{
+	return m_file.good();
+}
+
+bool FileAudioSink::write(const short* samples, int frames)
+{
+	  // WAV data is little-endian, as are the machines this builds on
+	unsigned int bytes = frames * MIXER_CHANNELS * sizeof(short);
+	m_file.write(reinterpret_cast<const char*>(samples), bytes);
+	m_dataBytes += bytes;
+	return m_file.good();
+}
+
+// DeviceAudioSink
+
+#ifdef _WIN32
+
+DeviceAudioSink::DeviceAudioSink()
+ : m_pipe(NULL)
+{
+}
+
+DeviceAudioSink::~DeviceAudioSink()
+{
+}
+
+bool DeviceAudioSink::write(const short* samples, int frames)
+{
+	return false;
+}
+
+#else
+
+DeviceAudioSink::DeviceAudioSink()
+ : m_pipe(NULL)
+{
+	if (system("command -v aplay >/dev/null 2>&1") != 0)
+		return;
+	  // A dead aplay must not take the game down with it
+	signal(SIGPIPE, SIG_IGN);
+	char command[128];
+	sprintf(command, "aplay -q -t raw -f S16_LE -c %d -r %d 2>/dev/null", MIXER_CHANNELS, MIXER_RATE);
+	m_pipe = popen(command, "w");
+}
+
+DeviceAudioSink::~DeviceAudioSink()
+{
+	if (m_pipe != NULL)
+		pclose(static_cast<FILE*>(m_pipe));
+}
+
+bool DeviceAudioSink::write(const short* samples, int frames)
+{
+	FILE* pipe = static_cast<FILE*>(m_pipe);
+	return pipe != NULL && fwrite(samples, MIXER_CHANNELS * sizeof(short), frames, pipe) == size_t(frames);
+}
+
+#endif // _WIN32
+
+bool DeviceAudioSink::isOpen() const
+{
+	return m_pipe != NULL;
+}
+
+AudioSink* createAudioSink(const string& spec)
+{
+	if (spec == "null")
+		return new NullAudioSink;
+	if (spec.compare(0, 5, "file:") == 0)
+	{
+		FileAudioSink* sink = new FileAudioSink(spec.substr(5));
+		if (sink->isOpen())
+			return sink;
+		cout << "Cannot write audio to " << spec.substr(5) << "; sound is off." << endl;
+		delete sink;
+		return new NullAudioSink;
+	}
+
+	DeviceAudioSink* sink = new DeviceAudioSink;
+	if (sink->isOpen())
+		return sink;
+	delete sink;
+	if (!spec.empty())
+		cout << "No audio device (aplay) found; sound is off." << endl;
+	return new NullAudioSink;
+}
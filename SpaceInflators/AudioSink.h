@@ -0,0 +1,61 @@
+#ifndef _AUDIOSINK_H_
+#define _AUDIOSINK_H_
+
+#include <string>
+#include <fstream>
+
+// Where the built-in mixer's output goes: 16-bit stereo blocks at
+// MIXER_RATE.  The mixer paces itself by the clock, so a sink may accept
+// data as fast as it likes.
+class AudioSink
+{
+  public:
+	virtual ~AudioSink() {}
+	virtual bool write(const short* samples, int frames) = 0;   // false if the sink has failed
+};
+
+// Discards everything; what the game uses when there is nowhere to play
+class NullAudioSink : public AudioSink
+{
+  public:
+	virtual bool write(const short*, int)
+	{
+		return true;
+	}
+};
+
+// Writes a WAV file, filling in its length when the sink is destroyed
+class FileAudioSink : public AudioSink
+{
+  public:
+	FileAudioSink(const std::string& path);
+	~FileAudioSink();
+
+	bool isOpen() const;
+	virtual bool write(const short* samples, int frames);
+
+  private:
+	std::ofstream m_file;
+	unsigned int  m_dataBytes;
+};
+
+// Pipes raw PCM to ALSA's aplay, when it is installed
+class DeviceAudioSink : public AudioSink
+{
+  public:
+	DeviceAudioSink();
+	~DeviceAudioSink();
+
+	bool isOpen() const;
+	virtual bool write(const short* samples, int frames);
+
+  private:
+	void* m_pipe;   // a FILE*
+};
+
+// The sink named by spec: "null", "file:PATH" or "device".  An empty spec
+// means the device if there is one and null otherwise.  Never returns
+// NULL; a sink that can't open falls back to null with a message.
+AudioSink* createAudioSink(const std::string& spec);
+
+#endif // _AUDIOSINK_H_
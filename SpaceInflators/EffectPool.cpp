@@ -0,0 +1,134 @@
+#include "EffectPool.h"
+#include <cmath>
+
+#if defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+#define EFFECTPOOL_SSE
+#include <xmmintrin.h>
+#endif
+
+namespace
+{
+	const double PI = 4 * atan(1.0);
+	const float  DRAG = .85f;   // fraction of its speed a particle keeps each tick
+
+	struct BurstStyle
+	{
+		int   count;
+		float minSpeed;
+		float maxSpeed;
+		int   minLife;
+		int   maxLife;
+		float r, g, b;
+	};
+
+	const BurstStyle BURST_STYLES[EffectPool::NUM_BURSTS] = {
+		{  4, .2f,  .5f, 2,  4, 1.0f, .8f, .3f },   // BURST_ALIEN_HIT
+		{ 16, .3f, 1.2f, 5, 10, 1.0f, .5f, .1f },   // BURST_ALIEN_DIE
+		{  8, .2f,  .7f, 3,  6, .3f, .6f, 1.0f }    // BURST_PLAYER_HIT
+	};
+}
+
+EffectPool::EffectPool()
+ : m_seed(12345)
+{
+	clear();
+}
+
+void EffectPool::clear()
+{
+	  // Every slot is stepped, alive or not, so keep them all defined
+	for (int i = 0; i < CAPACITY; i++)
+	{
+		m_x[i] = m_y[i] = m_prevX[i] = m_prevY[i] = 0;
+		m_vx[i] = m_vy[i] = 0;
+		m_life[i] = 0;
+		m_startLife[i] = 1;
+		m_kind[i] = 0;
+	}
+	m_next = 0;
+	m_numAlive = 0;
+	m_dropped = 0;
+}
+
+int EffectPool::random(int n)
+{
+	m_seed = m_seed * 1103515245 + 12345;
+	return int((m_seed >> 16) & 0x7fff) % n;
+}
+
+void EffectPool::burst(Burst kind, int x, int y)
+{
+	const BurstStyle& style = BURST_STYLES[kind];
+	for (int k = 0; k < style.count; k++)
+	{
+		int i = m_next;
+		m_next = (m_next + 1) % CAPACITY;
+		if (m_life[i] > 0)
+			m_dropped++;
+		else
+			m_numAlive++;
+
+		double theta = 2*PI * random(1000) / 1000.0;
+		float speed = style.minSpeed + (style.maxSpeed - style.minSpeed) * random(1000) / 1000.0f;
+		m_x[i] = m_prevX[i] = float(x);
+		m_y[i] = m_prevY[i] = float(y);
+		m_vx[i] = float(cos(theta)) * speed;
+		m_vy[i] = float(sin(theta)) * speed;
+		m_life[i] = m_startLife[i] = float(style.minLife + random(style.maxLife - style.minLife + 1));
+		m_kind[i] = (unsigned char)kind;
+	}
+}
+
+void EffectPool::step()
+{
+	if (m_numAlive == 0)
+		return;
+
+	  // Dead slots go along for the ride; their life just stays at 0
+#ifdef EFFECTPOOL_SSE
+	const __m128 drag = _mm_set1_ps(DRAG);
+	const __m128 one  = _mm_set1_ps(1);
+	const __m128 zero = _mm_setzero_ps();
+	for (int i = 0; i < CAPACITY; i += 4)
+	{
+		__m128 x  = _mm_loadu_ps(m_x + i);
+		__m128 y  = _mm_loadu_ps(m_y + i);
+		__m128 vx = _mm_loadu_ps(m_vx + i);
+		__m128 vy = _mm_loadu_ps(m_vy + i);
+		_mm_storeu_ps(m_prevX + i, x);
+		_mm_storeu_ps(m_prevY + i, y);
+		_mm_storeu_ps(m_x + i, _mm_add_ps(x, vx));
+		_mm_storeu_ps(m_y + i, _mm_add_ps(y, vy));
+		_mm_storeu_ps(m_vx + i, _mm_mul_ps(vx, drag));
+		_mm_storeu_ps(m_vy + i, _mm_mul_ps(vy, drag));
+		_mm_storeu_ps(m_life + i, _mm_max_ps(_mm_sub_ps(_mm_loadu_ps(m_life + i), one), zero));
+	}
+#else
+	for (int i = 0; i < CAPACITY; i++)
+	{
+		m_prevX[i] = m_x[i];
+		m_prevY[i] = m_y[i];
+		m_x[i] += m_vx[i];
+		m_y[i] += m_vy[i];
+		m_vx[i] *= DRAG;
+		m_vy[i] *= DRAG;
+		m_life[i] = m_life[i] > 1 ? m_life[i] - 1 : 0;
+	}
+#endif
+
+	m_numAlive = 0;
+	for (int i = 0; i < CAPACITY; i++)
+	{
+		if (m_life[i] > 0)
+			m_numAlive++;
+	}
+}
+
+void EffectPool::getColor(int i, float& r, float& g, float& b) const
+{
+	const BurstStyle& style = BURST_STYLES[m_kind[i]];
+	float fade = getFade(i);
+	r = style.r * fade;
+	g = style.g * fade;
+	b = style.b * fade;
+}
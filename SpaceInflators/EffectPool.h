@@ -0,0 +1,89 @@
+#ifndef _EFFECTPOOL_H_
+#define _EFFECTPOOL_H_
+
+// Short-lived debris particles thrown off when ships are hit or destroyed.
+// Particles live in a preallocated structure-of-arrays ring: a burst never
+// allocates, and once the ring is full each new particle overwrites the
+// oldest one, so a long torpedo chain costs at most CAPACITY particles to
+// update and draw.  Positions are in board cells, the same coordinates
+// actors use, and velocities in cells per tick.
+class EffectPool
+{
+  public:
+	static const int CAPACITY = 256;   // must be a multiple of 4
+
+	enum Burst {
+		BURST_ALIEN_HIT, BURST_ALIEN_DIE, BURST_PLAYER_HIT,
+		NUM_BURSTS
+	};
+
+	EffectPool();
+
+	void burst(Burst kind, int x, int y);   // throw debris out of cell (x, y)
+	void step();    // advance every particle one tick
+	void clear();
+
+	  // Slots are iterated 0..CAPACITY-1; only those that are alive hold a particle
+	bool isAlive(int i) const
+	{
+		return m_life[i] > 0;
+	}
+
+	float getX(int i) const
+	{
+		return m_x[i];
+	}
+
+	float getY(int i) const
+	{
+		return m_y[i];
+	}
+
+	  // Position before the last step, for drawing part way through the tick
+	float getPrevX(int i) const
+	{
+		return m_prevX[i];
+	}
+
+	float getPrevY(int i) const
+	{
+		return m_prevY[i];
+	}
+
+	  // 1 when the particle is new, falling to 0 as it dies
+	float getFade(int i) const
+	{
+		return m_life[i] / m_startLife[i];
+	}
+
+	void getColor(int i, float& r, float& g, float& b) const;
+
+	int getNumAlive() const
+	{
+		return m_numAlive;
+	}
+
+	unsigned int getDropped() const
+	{
+		return m_dropped;
+	}
+
+  private:
+	int random(int n);   // own LCG so effects never disturb the world's random sequence
+
+	float m_x[CAPACITY];
+	float m_y[CAPACITY];
+	float m_prevX[CAPACITY];
+	float m_prevY[CAPACITY];
+	float m_vx[CAPACITY];
+	float m_vy[CAPACITY];
+	float m_life[CAPACITY];        // ticks left
+	float m_startLife[CAPACITY];
+	unsigned char m_kind[CAPACITY];
+	int m_next;                    // slot the next particle goes in (the oldest once full)
+	int m_numAlive;
+	unsigned int m_dropped;        // live particles overwritten before they died
+	unsigned int m_seed;
+};
+
+#endif // _EFFECTPOOL_H_
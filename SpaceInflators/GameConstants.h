@@ -13,6 +13,7 @@ const int IID_FREE_SHIP_GOODIE = 6;
 const int IID_ENERGY_GOODIE    = 7;
 const int IID_TORPEDO_GOODIE   = 8;
 const int IID_STAR             = 9;
+const int NUM_IMAGE_IDS        = 10;
 
 // sounds
 
@@ -25,6 +26,20 @@ const int SOUND_PLAYER_HIT             = 5;
 const int SOUND_ENEMY_HIT              = 6;
 const int SOUND_ENEMY_PLAYER_COLLISION = 7;
 const int SOUND_PLAYER_TORPEDO         = 8;
+const int NUM_SOUNDS                   = 9;
+
+  // The clip each sound plays
+const char* const SOUND_FILES[NUM_SOUNDS] = {
+	"explode2.wav",   // SOUND_ENEMY_DIE
+	"explode2.wav",   // SOUND_PLAYER_DIE
+	"laser.wav",      // SOUND_PLAYER_FIRE
+	"laser.wav",      // SOUND_ENEMY_FIRE
+	"goodie.wav",     // SOUND_GOT_GOODIE
+	"clank.wav",      // SOUND_PLAYER_HIT
+	"damage.wav",     // SOUND_ENEMY_HIT
+	"explode.wav",    // SOUND_ENEMY_PLAYER_COLLISION
+	"torpedo.wav"     // SOUND_PLAYER_TORPEDO
+};
 
 // keys the user can hit
 
@@ -9,17 +9,24 @@
 #include "GameConstants.h"
 #include "GraphObject.h"
 #include "SoundFX.h"
+#include "SoftRaster.h"
+#include "Telemetry.h"
+#include "StarField.h"
+#include "EffectPool.h"
+#include "Metrics.h"
+#include "ActorStats.h"
 #include <string>
 #include <map>
 #include <utility>
+#include <vector>
+#include <algorithm>
 #include <cstdlib>
+#include <thread>
 using namespace std;
 
 static const double SCORE_Y = 3.8;
 static const double SCORE_Z = -10;
 
-static const int MS_PER_FRAME = 10;
-
 static const double VISIBLE_MIN_X = -3.25;
 static const double VISIBLE_MAX_X = 3.25;
 static const double VISIBLE_MIN_Y = -2;
@@ -45,6 +52,7 @@ struct Point
 
 static void drawPrompt(string mainMessage, string secondMessage);
 static void drawScoreAndLives(string);
+static void drawOverlay(string);
 
 static void drawPlayer(GraphObject* go);
 static void drawNachling(GraphObject* go);
@@ -53,39 +61,43 @@ static void drawSmallbot(GraphObject* go);
 static void drawBullet(GraphObject* go);
 static void drawTorpedo(GraphObject* go);
 static void drawGoodie(GraphObject* go);
-static void drawStar(GraphObject* go);
+static void drawStarField(const StarField& stars, double tickFraction);
+static void drawEffects(const EffectPool& effects, double tickFraction);
+
+// Buckets are drawn front to back: with the depth test on, the first
+// fragment drawn at a given depth wins, so the star field goes last.
+static const int DRAW_ORDER[] = {
+	IID_PLAYER_SHIP, IID_NACHLING, IID_WEALTHY_NACHLING, IID_SMALLBOT,
+	IID_BULLET, IID_TORPEDO,
+	IID_FREE_SHIP_GOODIE, IID_ENERGY_GOODIE, IID_TORPEDO_GOODIE
+};
 
 void GameController::initDrawersAndSounds()
 {
-	DrawMapType::value_type drawers[] = {
-		make_pair(IID_PLAYER_SHIP      , &drawPlayer),
-		make_pair(IID_NACHLING         , &drawNachling),
-		make_pair(IID_WEALTHY_NACHLING , &drawWealthyNachling),
-		make_pair(IID_SMALLBOT         , &drawSmallbot),
-		make_pair(IID_BULLET           , &drawBullet),
-		make_pair(IID_TORPEDO          , &drawTorpedo),
-		make_pair(IID_FREE_SHIP_GOODIE , &drawGoodie),
-		make_pair(IID_ENERGY_GOODIE    , &drawGoodie),
-		make_pair(IID_TORPEDO_GOODIE   , &drawGoodie),
-		make_pair(IID_STAR             , &drawStar),
-	};
-
-	SoundMapType::value_type sounds[] = {
-		make_pair(SOUND_ENEMY_DIE              , "explode2.wav"),
-		make_pair(SOUND_PLAYER_DIE             , "explode2.wav"),
-		make_pair(SOUND_PLAYER_FIRE            , "laser.wav"),
-		make_pair(SOUND_ENEMY_FIRE             , "laser.wav"),
-		make_pair(SOUND_GOT_GOODIE             , "goodie.wav"),
-		make_pair(SOUND_PLAYER_HIT             , "clank.wav"),
-		make_pair(SOUND_ENEMY_HIT              , "damage.wav"),
-		make_pair(SOUND_ENEMY_PLAYER_COLLISION , "explode.wav"),
-		make_pair(SOUND_PLAYER_TORPEDO         , "torpedo.wav"),
+	struct { int imageID; void (*draw)(GraphObject*); float lineWidth; } drawers[] = {
+		{ IID_PLAYER_SHIP      , &drawPlayer         , 1 },
+		{ IID_NACHLING         , &drawNachling       , 1 },
+		{ IID_WEALTHY_NACHLING , &drawWealthyNachling, 2 },
+		{ IID_SMALLBOT         , &drawSmallbot       , 1 },
+		{ IID_BULLET           , &drawBullet         , 1 },
+		{ IID_TORPEDO          , &drawTorpedo        , 1 },
+		{ IID_FREE_SHIP_GOODIE , &drawGoodie         , 1 },
+		{ IID_ENERGY_GOODIE    , &drawGoodie         , 1 },
+		{ IID_TORPEDO_GOODIE   , &drawGoodie         , 1 },
 	};
 	
+	for (int k = 0; k < NUM_IMAGE_IDS; k++)
+	{
+		m_drawers[k].draw = NULL;
+		m_drawers[k].lineWidth = 1;
+	}
 	for (int k = 0; k < sizeof(drawers)/sizeof(drawers[0]); k++)
-		m_drawMap[drawers[k].first] = drawers[k].second;
-	for (int k = 0; k < sizeof(sounds)/sizeof(sounds[0]); k++)
-		m_soundMap[sounds[k].first] = sounds[k].second;
+	{
+		m_drawers[drawers[k].imageID].draw = drawers[k].draw;
+		m_drawers[drawers[k].imageID].lineWidth = drawers[k].lineWidth;
+	}
+	for (int k = 0; k < NUM_SOUNDS; k++)
+		m_soundMap[k] = SOUND_FILES[k];
 }
 
 static void doSomethingCallback()
@@ -108,24 +120,74 @@ static void specialKeyboardEventCallback(int key, int x, int y)
 	Game().specialKeyboardEvent(key, x, y);
 }
 
+static void keyboardUpEventCallback(unsigned char key, int x, int y)
+{
+	Game().keyboardUpEvent(key, x, y);
+}
+
+static void specialKeyboardUpEventCallback(int key, int x, int y)
+{
+	Game().specialKeyboardUpEvent(key, x, y);
+}
+
 static void timerFuncCallback(int val)
 {
+	Telem().markTimerCallback();
 	Game().doSomething();
 	glutTimerFunc(MS_PER_FRAME, timerFuncCallback, 0);
 }
 
+GameController::GameController()
+ : m_gw(NULL), m_softRaster(NULL), m_softFrame(NULL)
+{
+}
+
+GameController::~GameController()
+{
+	delete m_softRaster;
+	delete m_softFrame;
+}
+
 void GameController::run(GameWorld* gw, int testParams[], string windowTitle)
 {
 	gw->setTestParams(testParams);
 	gw->setController(this);
 	m_gw = gw;
 	m_gameState = welcome;
-	m_lastKeyHit = INVALID_KEY;
+	m_maxInputQueueDepth = 0;
+	m_droppedInputEvents = 0;
+	for (int k = 0; k < NUM_KEY_SLOTS; k++)
+		m_keyHeld[k] = false;
 	m_singleStep = false;
+	m_softwareRendering = false;
+	m_showInputLatency = false;
+	m_volume = 1;
+	m_pendingInputTime = 0;
+	m_lastInputLatency = 0;
+	m_windowWidth = WINDOW_WIDTH;
+	m_windowHeight = WINDOW_HEIGHT;
 	m_curIntraFrameTick = 0;
+	m_tickStartTime = 0;
+	m_tickFraction = 1;
+
+	m_softFrame = new SoftFramebuffer(WINDOW_WIDTH, WINDOW_HEIGHT);
+	m_softRaster = new SoftRasterizer;
+	m_softRaster->setThreadCount(thread::hardware_concurrency());
 
+	  // Registered first so it prints after the telemetry summary
+	atexit(writeInputSummaryAtExit);
+	Telem().start(MS_PER_FRAME);
 	initDrawersAndSounds();
 
+	  // Start the audio thread loading clips while GLUT sets up the window
+	vector<string> soundFiles(1, "theme.wav");
+	for (SoundMapType::const_iterator p = m_soundMap.begin(); p != m_soundMap.end(); p++)
+	{
+		if (find(soundFiles.begin(), soundFiles.end(), p->second) == soundFiles.end())
+			soundFiles.push_back(p->second);
+	}
+	SoundFX().preload(soundFiles);
+
 	glutInitDisplayMode(GLUT_RGB | GLUT_DEPTH | GLUT_DOUBLE);
 	glutInitWindowSize(WINDOW_WIDTH, WINDOW_HEIGHT); 
 	glutInitWindowPosition(0, 0); 
@@ -133,6 +195,8 @@ void GameController::run(GameWorld* gw, int testParams[], string windowTitle)
 
 	glutKeyboardFunc(keyboardEventCallback);
 	glutSpecialFunc(specialKeyboardEventCallback);
+	glutKeyboardUpFunc(keyboardUpEventCallback);
+	glutSpecialUpFunc(specialKeyboardUpEventCallback);
 	glutReshapeFunc(reshapeCallback);
 	glutDisplayFunc(doSomethingCallback);
 	glutTimerFunc(MS_PER_FRAME, timerFuncCallback, 0);
@@ -140,31 +204,109 @@ void GameController::run(GameWorld* gw, int testParams[], string windowTitle)
 	glutMainLoop(); 
 }
 
+static int translateKey(unsigned char key)
+{
+	switch (key)
+	{
+		case 'a': case '4': return KEY_PRESS_LEFT;
+		case 'd': case '6': return KEY_PRESS_RIGHT;
+		case 'w': case '8': return KEY_PRESS_UP;
+		case 's': case '2': return KEY_PRESS_DOWN;
+		case 't':           return KEY_PRESS_TAB;
+		default:            return key;
+	}
+}
+
+static int translateSpecialKey(int key)
+{
+	switch (key)
+	{
+		case GLUT_KEY_LEFT:  return KEY_PRESS_LEFT;
+		case GLUT_KEY_RIGHT: return KEY_PRESS_RIGHT;
+		case GLUT_KEY_UP:    return KEY_PRESS_UP;
+		case GLUT_KEY_DOWN:  return KEY_PRESS_DOWN;
+		default:             return INVALID_KEY;
+	}
+}
+
+static int keySlot(int key)
+{
+	if (key >= KEY_PRESS_LEFT && key <= KEY_PRESS_DOWN)
+		return 256 + key - KEY_PRESS_LEFT;
+	return key >= 0 && key < 256 ? key : -1;
+}
+
+void GameController::postKey(int key, bool pressed)
+{
+	if (key == INVALID_KEY)
+		return;
+	int slot = keySlot(key);
+	bool repeat = pressed && slot >= 0 && m_keyHeld[slot];
+	if (slot >= 0)
+		m_keyHeld[slot] = pressed;
+	if (!pressed)
+		return;
+	  // Auto-repeat of a held key only refills an empty queue, so holding a
+	  // key can't build a backlog the player then watches drain
+	if (repeat && m_inputQueue.size() > 0)
+		return;
+
+	InputEvent event;
+	event.key = key;
+	event.timestamp = Telemetry::now();
+	if (!m_inputQueue.push(event))
+		m_droppedInputEvents++;
+	unsigned int depth = m_inputQueue.size();
+	if (depth > m_maxInputQueueDepth)
+		m_maxInputQueueDepth = depth;
+}
+
+void GameController::writeInputSummaryAtExit()
+{
+	const GameController& gc = getInstance();
+	cout << "Input: " << gc.getMaxInputQueueDepth() << " of " << INPUT_QUEUE_CAPACITY
+	     << " queue slots used at most, " << gc.getDroppedInputEvents() << " key presses dropped, "
+	     << gc.getInputQueueDepth() << " still queued at exit" << endl;
+}
+
 void GameController::keyboardEvent(unsigned char key, int x, int y)
 {
 	switch (key)
 	{
-		case 'a': case '4': m_lastKeyHit = KEY_PRESS_LEFT;  break;
-		case 'd': case '6': m_lastKeyHit = KEY_PRESS_RIGHT; break;
-		case 'w': case '8': m_lastKeyHit = KEY_PRESS_UP;    break;
-		case 's': case '2': m_lastKeyHit = KEY_PRESS_DOWN;  break;
-		case 't':           m_lastKeyHit = KEY_PRESS_TAB;   break;
 		case 'f':           m_singleStep = true;            break;
 		case 'r':           m_singleStep = false;           break;
-		default:            m_lastKeyHit = key;             break;
+		case 'b':           m_softwareRendering = !m_softwareRendering; break;
+		case 'l':           m_showInputLatency = !m_showInputLatency;   break;
+		case '-':           changeVolume(-0.1f);            break;
+		case '=': case '+': changeVolume(0.1f);             break;
+		case 'm':           ActorStats::writeProcessReport(cout, m_gw->getActorStats()); break;
+		default:            postKey(translateKey(key), true); break;
 	}
 }
 
+void GameController::changeVolume(float delta)
+{
+	m_volume += delta;
+	if (m_volume < 0)
+		m_volume = 0;
+	else if (m_volume > 1)
+		m_volume = 1;
+	SoundFX().setVolume(m_volume);
+}
+
+void GameController::keyboardUpEvent(unsigned char key, int, int)
+{
+	postKey(translateKey(key), false);
+}
+
 void GameController::specialKeyboardEvent(int key, int x, int y)
 {
-	switch (key)
-	{
-		case GLUT_KEY_LEFT:  m_lastKeyHit = KEY_PRESS_LEFT;  break;
-		case GLUT_KEY_RIGHT: m_lastKeyHit = KEY_PRESS_RIGHT; break;
-		case GLUT_KEY_UP:    m_lastKeyHit = KEY_PRESS_UP;    break;
-		case GLUT_KEY_DOWN:  m_lastKeyHit = KEY_PRESS_DOWN;  break;
-		default:             m_lastKeyHit = INVALID_KEY;     break;
-	}
+	postKey(translateSpecialKey(key), true);
+}
+
+void GameController::specialKeyboardUpEvent(int key, int, int)
+{
+	postKey(translateSpecialKey(key), false);
 }
 
 void GameController::playSound(int soundID)
@@ -193,12 +335,24 @@ void GameController::doSomething()
 			break;
 		case makemove:
 			m_curIntraFrameTick = ANIMATION_POSITIONS_PER_TICK;
-			if (m_gw->move() != GWSTATUS_PLAYER_DIED)
-				m_gameState = animate;
-			else if (m_gw->isGameOver())
-				m_gameState = gameover;
-			else
-				m_gameState = contgame;
+			{
+				std::set<GraphObject*>& graphObjects = GraphObject::getGraphObjects();
+				for (std::set<GraphObject*>::iterator it = graphObjects.begin(); it != graphObjects.end(); it++)
+					(*it)->beginTick();
+
+				long long moveStart = Telemetry::now();
+				m_tickStartTime = moveStart;
+				int status = m_gw->move();
+				Telem().recordSpan(Telemetry::SPAN_MOVE, moveStart);
+				if (m_gw->getMetrics() != NULL)
+					m_gw->getMetrics()->recordTick(Telemetry::now() - moveStart);
+				if (status != GWSTATUS_PLAYER_DIED)
+					m_gameState = animate;
+				else if (m_gw->isGameOver())
+					m_gameState = gameover;
+				else
+					m_gameState = contgame;
+			}
 			break;
 		case animate:
 			displayGamePlay();
@@ -225,10 +379,14 @@ void GameController::doSomething()
 			break;
 		case prompt:
 			drawPrompt(m_mainMessage, m_secondMessage);
+			Telem().markPromptPresented();
 			{
 				int key;
 				if (getLastKey(key) && key == '\r')
+				{
+					Telem().markPromptDismissed();
 					m_gameState = m_nextStateAfterPrompt;
+				}
 			}
 			break;
 		case init:
@@ -241,33 +399,123 @@ void GameController::doSomething()
 	}
 }
 
+void GameController::inputApplied(long long timestamp)
+{
+	Telem().recordSpan(Telemetry::SPAN_INPUT_TO_MOVE, timestamp);
+	if (m_pendingInputTime == 0 || timestamp < m_pendingInputTime)
+		m_pendingInputTime = timestamp;
+}
+
+string GameController::inputLatencyText() const
+{
+	const LatencyHistogram& h = Telem().getSpan(Telemetry::SPAN_INPUT_TO_DISPLAY);
+	ostringstream oss;
+	oss << "Input lag: last " << m_lastInputLatency / 1000 << " ms  p50 " << h.getPercentile(50) / 1000
+	    << " ms  p99 " << h.getPercentile(99) / 1000 << " ms";
+	return oss.str();
+}
+
 void GameController::displayGamePlay()
+{
+	long long displayStart = Telemetry::now();
+	m_tickFraction = double(displayStart - m_tickStartTime) / (MS_PER_TICK * 1000.0);
+	string overlay = m_showInputLatency ? inputLatencyText() : "";
+	if (m_softwareRendering)
+		displaySoftware(overlay);
+	else
+		displayOpenGL(overlay);
+	Telem().recordSpan(Telemetry::SPAN_DISPLAY, displayStart);
+
+	long long swapStart = Telemetry::now();
+	glutSwapBuffers();
+	Telem().recordSpan(Telemetry::SPAN_SWAP, swapStart);
+	Telem().markFramePresented();
+	metricsAdd(m_gw->getMetrics(), METRIC_FRAMES);
+
+	  // This is the first frame showing the player's response to that key
+	if (m_pendingInputTime != 0)
+	{
+		m_lastInputLatency = Telemetry::now() - m_pendingInputTime;
+		Telem().recordSpan(Telemetry::SPAN_INPUT_TO_DISPLAY, m_pendingInputTime);
+		m_pendingInputTime = 0;
+	}
+}
+
+void GameController::displayOpenGL(const string& overlayText)
 {
 	glEnable(GL_DEPTH_TEST); // must be done each time before displaying graphics or gets disabled for some reason
 	glLoadIdentity();
 	glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 	gluLookAt(0, 0, 0, 0, 0, -1, 0, 1, 0);
 	
+	for (int k = 0; k < NUM_IMAGE_IDS; k++)
+		m_drawBuckets[k].clear();
+
 	std::set<GraphObject*>& graphObjects = GraphObject::getGraphObjects();
 	for (std::set<GraphObject*>::iterator it = graphObjects.begin(); it != graphObjects.end(); it++)
 	{
 		GraphObject* cur = *it;
 		if (cur->isVisible())
 		{
-			cur->animate();
-			DrawMapType::const_iterator p = m_drawMap.find(cur->getID());
-			if (p != m_drawMap.end())
-				(*p->second)(cur);  // draw routine for the current object
+			cur->animate(m_tickFraction);
+			unsigned int id = cur->getID();
+			if (id < NUM_IMAGE_IDS  &&  m_drawers[id].draw != NULL)
+				m_drawBuckets[id].push_back(cur);
 		}
 	}
+
+	for (int k = 0; k < sizeof(DRAW_ORDER)/sizeof(DRAW_ORDER[0]); k++)
+	{
+		const Drawer& drawer = m_drawers[DRAW_ORDER[k]];
+		std::vector<GraphObject*>& bucket = m_drawBuckets[DRAW_ORDER[k]];
+		if (bucket.empty())
+			continue;
+		glLineWidth(drawer.lineWidth);
+		for (size_t i = 0; i < bucket.size(); i++)
+			(*drawer.draw)(bucket[i]);  // draw routine for the current object
+	}
+
+	const StarField* stars = m_gw->getStarField();
+	if (stars != NULL)
+		drawStarField(*stars, m_tickFraction);
+	const EffectPool* effects = m_gw->getEffects();
+	if (effects != NULL  &&  effects->getNumAlive() > 0)
+		drawEffects(*effects, m_tickFraction);
 	
 	drawScoreAndLives(m_gameStatText);
-	
-	glutSwapBuffers();
+	if (!overlayText.empty())
+		drawOverlay(overlayText);
+}
+
+void GameController::displaySoftware(const string& overlayText)
+{
+	if (m_softFrame->getWidth() != m_windowWidth || m_softFrame->getHeight() != m_windowHeight)
+		m_softFrame->resize(m_windowWidth, m_windowHeight);
+	softRenderFrame(*m_softRaster, *m_softFrame, GraphObject::getGraphObjects(), m_gw->getStarField(),
+	                m_gw->getEffects(), m_gameStatText, m_tickFraction, overlayText);
+
+	  // Blit the finished frame; row 0 of the framebuffer is the top of the window
+	glDisable(GL_DEPTH_TEST);
+	glMatrixMode(GL_PROJECTION);
+	glPushMatrix();
+	glLoadIdentity();
+	gluOrtho2D(0, m_windowWidth, 0, m_windowHeight);
+	glMatrixMode(GL_MODELVIEW);
+	glLoadIdentity();
+	glRasterPos2d(0, m_windowHeight - .5);
+	glPixelZoom(1, -1);
+	glDrawPixels(m_softFrame->getWidth(), m_softFrame->getHeight(), GL_RGBA, GL_UNSIGNED_BYTE,
+	             m_softFrame->getPixels());
+	glPixelZoom(1, 1);
+	glMatrixMode(GL_PROJECTION);
+	glPopMatrix();
+	glMatrixMode(GL_MODELVIEW);
 }
 
 void GameController::reshape (int w, int h) 
 {
+	m_windowWidth = w;
+	m_windowHeight = h;
 	glViewport (0, 0, (GLsizei) w, (GLsizei) h); 
 	glMatrixMode (GL_PROJECTION); 
 	glLoadIdentity ();
@@ -379,16 +627,18 @@ static void drawScoreAndLives(string gameStatText)
 	outputStrokeCentered(SCORE_Y, SCORE_Z, gameStatText.c_str());
 }
 
+static void drawOverlay(string text)
+{
+	glColor3f(.6, .6, .6);
+	outputStrokeCentered(-SCORE_Y, SCORE_Z, text.c_str());
+}
+
 static void drawPlayer(GraphObject* go)
 {
 	double x, y;
 	go->getAnimationLocation(x,y);
 	
-	glPushMatrix();
-	
 	glColor3f(.8, .7, .7);
-	glLineWidth(1);
-	
 	Point playertop[] = { { .35, .3 }, { .5, 1 }, { .65, .3 } };
 	drawPolyFromBaseXYFlat(x, y, playertop, sizeof(playertop)/sizeof(playertop[0]));
 	Point playerbot[] = { { .2, .0 }, { .5, .6 }, { .8, .0 } };
@@ -406,8 +656,6 @@ static void drawPlayer(GraphObject* go)
 	Point exhaust2[] = { { .80, -length }, { .70, 0 }, { .60, -length } };
 	drawLineFromBaseXY(x, y, exhaust1, sizeof(exhaust1)/sizeof(exhaust1[0]));
 	drawLineFromBaseXY(x, y, exhaust2, sizeof(exhaust2)/sizeof(exhaust2[0]));
-	
-	glPopMatrix();
 }
 
 static void drawNachling(GraphObject* go)
@@ -415,11 +663,7 @@ static void drawNachling(GraphObject* go)
 	double x, y;
 	go->getAnimationLocation(x, y);
 	
-	glPushMatrix();
-	
 	glColor3f (1.0, .3, .5);
-	glLineWidth(1);
-	
 	glBegin(GL_LINE_LOOP);
 	for (int i = 0; i < 360; i += 5)
 	{
@@ -444,8 +688,6 @@ static void drawNachling(GraphObject* go)
 	glColor3f(rand()%10 * 1.0 / 10, rand()%10 * 1.0 / 10, rand()%10 * 1.0 / 10);
 	Point base3[] = { { .8, .4 }, { .9, .4 }, { .9, .6 }, { .8, .6} };
 	drawPolyFromBaseXY(x, y, base3, sizeof(base3)/sizeof(base3[0]));
-	
-	glPopMatrix();
 }
 
 static void drawWealthyNachling(GraphObject* go)
@@ -453,11 +695,7 @@ static void drawWealthyNachling(GraphObject* go)
 	double x, y;
 	go->getAnimationLocation(x, y);
 
-	glPushMatrix();
-	
 	glColor3f (.3, .3, 1.0);
-	glLineWidth(2);
-	
 	glBegin(GL_LINE_LOOP);
 	for (int i = 0; i < 360; i += 5)
 	{
@@ -481,8 +719,6 @@ static void drawWealthyNachling(GraphObject* go)
 		shift = .5 - .1 * (anim-6);
 	Point base[] = { { .1+shift, .4 }, { .4+shift, .4 } , { .4+shift, .6 }, { .1+shift, .6 } };
 	drawPolyFromBaseXY(x, y, base, sizeof(base)/sizeof(base[0]));
-	
-	glPopMatrix();
 }
 
 static void drawSmallbot(GraphObject* go)
@@ -490,11 +726,7 @@ static void drawSmallbot(GraphObject* go)
 	double x, y;
 	go->getAnimationLocation(x, y);
 
-	glPushMatrix();
-	
 	glColor3f (0, .8, 0.8);
-	glLineWidth(1);
-	
 	Point ship[] = { { 0, 1 }, { .5, 0 }, { 1, 1 } };
 	drawPolyFromBaseXY(x, y, ship, sizeof(ship)/sizeof(ship[0]));
 	
@@ -504,8 +736,6 @@ static void drawSmallbot(GraphObject* go)
 	Point exhaust2[] = { { .80, 1+length }, { .70, 1.0 }, { .60, 1+length } };
 	drawLineFromBaseXY(x, y, exhaust1, sizeof(exhaust1)/sizeof(exhaust1[0]));
 	drawLineFromBaseXY(x, y, exhaust2, sizeof(exhaust2)/sizeof(exhaust2[0]));
-	
-	glPopMatrix();
 }
 
 static void drawBullet(GraphObject* go)
@@ -513,15 +743,9 @@ static void drawBullet(GraphObject* go)
 	double x, y;
 	go->getAnimationLocation(x, y);
 
-	glPushMatrix();
-
 	glColor3f (1.0, 0, 0);
-	glLineWidth(1);
-	
 	Point bullet[] = { { .4, .5 }, { .5, .6 }, { .6, .5 }, { .5, .4 } };
 	drawPolyFromBaseXY(x, y, bullet, sizeof(bullet)/sizeof(bullet[0]));
-
-	glPopMatrix();
 }
 
 static void drawGoodie(GraphObject* go)
@@ -538,8 +762,6 @@ static void drawGoodie(GraphObject* go)
 	glTranslatef(gx, gy, gz);
 	glColor3f(0.0*brightness, 0.0*brightness, 1.0*brightness);
 	
-	glLineWidth(1);
-
 	glBegin( GL_POLYGON );
 	double r = .2;
 	for( float i = 0; i < 10; i++)
@@ -553,8 +775,6 @@ static void drawGoodie(GraphObject* go)
 	
 	glPopMatrix();
 	
-	glPushMatrix();
-	
 	glColor3f(1.0*brightness, 0.2*brightness, 0.3*brightness);
 	
 	char goodieChar[2] = "";
@@ -566,34 +786,15 @@ static void drawGoodie(GraphObject* go)
 	}
 	
 	outputStroke(gx, gy, gz, 1, goodieChar);
-
-	glPopMatrix();
 }
 
-static void drawStarOrTorpedo(GraphObject* go, bool torpedo)
+static void drawTorpedo(GraphObject* go)
 {
 	double x, y;
 	go->getAnimationLocation(x, y);
 	
-	glPushMatrix();
-	
-	double length;
-
-	if (torpedo)
-	{
-		glColor3f(1.0, 0, 0);
-		length = (rand() % 100) / 100.0;
-	}
-	else
-	{
-		double brightness = (rand()%100) / 100.0;
-		if (brightness < .2)
-			brightness = .2;
-		glColor3f(brightness, brightness, brightness);
-		length = (rand() % 100) / 500.0;
-	}
-	
-	glLineWidth(1);
+	glColor3f(1.0, 0, 0);
+	double length = (rand() % 100) / 100.0;
 	
 	for (int i = 0; i < 5; i++)
 	{
@@ -603,15 +804,66 @@ static void drawStarOrTorpedo(GraphObject* go, bool torpedo)
 		Point line[] = { { .5, .5 }, { dx+.5, dy+.5 } };
 		drawLineFromBaseXY(x, y, line, sizeof(line)/sizeof(line[0]));
 	}
-	glPopMatrix();
 }
 
-static void drawStar(GraphObject* go)
+// All stars in one batch of lines; each is five random rays around its centre
+static void drawStarField(const StarField& stars, double tickFraction)
 {
-	drawStarOrTorpedo(go, false);
+	if (tickFraction > 1)
+		tickFraction = 1;
+	double xmult = double(VISIBLE_MAX_X - VISIBLE_MIN_X) / VIEW_WIDTH;
+	double ymult = double(VISIBLE_MAX_Y - VISIBLE_MIN_Y) / VIEW_HEIGHT;
+	
+	glLineWidth(1);
+	glBegin(GL_LINES);
+	for (int k = 0; k < stars.size(); k++)
+	{
+		double y = stars.getPrevY(k) + (stars.getY(k) - stars.getPrevY(k)) * tickFraction;
+		double gx, gy, gz;
+		convertToGlutCoords(stars.getX(k), y, gx, gy, gz);
+		
+		double brightness = (rand()%100) / 100.0;
+		if (brightness < .2)
+			brightness = .2;
+		glColor3f(brightness, brightness, brightness);
+		double length = (rand() % 100) / 500.0;
+		
+		for (int i = 0; i < 5; i++)
+		{
+			double theta = 2*PI * (rand() % 1000) / 1000.0;
+			glVertex3f(gx, gy, gz);
+			glVertex3f(gx + xmult*cos(theta)*length, gy + ymult*sin(theta)*length, gz);
+		}
+	}
+	glEnd();
 }
 
-static void drawTorpedo(GraphObject* go)
+// All debris in one batch of lines; each particle is a streak trailing
+// half a tick's travel behind it
+static void drawEffects(const EffectPool& effects, double tickFraction)
 {
-	drawStarOrTorpedo(go, true);
+	if (tickFraction > 1)
+		tickFraction = 1;
+	
+	glLineWidth(1);
+	glBegin(GL_LINES);
+	for (int i = 0; i < EffectPool::CAPACITY; i++)
+	{
+		if (!effects.isAlive(i))
+			continue;
+		double dx = effects.getX(i) - effects.getPrevX(i);
+		double dy = effects.getY(i) - effects.getPrevY(i);
+		double x = effects.getPrevX(i) + dx * tickFraction;
+		double y = effects.getPrevY(i) + dy * tickFraction;
+		
+		float r, g, b;
+		effects.getColor(i, r, g, b);
+		glColor3f(r, g, b);
+		double gx, gy, gz;
+		convertToGlutCoords(x, y, gx, gy, gz);
+		glVertex3f(gx, gy, gz);
+		convertToGlutCoords(x - dx/2, y - dy/2, gx, gy, gz);
+		glVertex3f(gx, gy, gz);
+	}
+	glEnd();
 }
@@ -1,8 +1,11 @@
 #ifndef _GAMECONTROLLER_H_
 #define _GAMECONTROLLER_H_
 
+#include "GameConstants.h"
+#include "SpscRing.h"
 #include <string>
 #include <map>
+#include <vector>
 #include <iostream>
 #include <sstream>
 
@@ -12,27 +15,79 @@ enum GC_STATE {
 
 const int INVALID_KEY = 0;
 
+  // A key press as delivered by GLUT, stamped with Telemetry::now()
+struct InputEvent
+{
+	int       key;
+	long long timestamp;
+};
+
+const unsigned int INPUT_QUEUE_CAPACITY = 64;
+const int          NUM_KEY_SLOTS        = 256 + 4;   // ASCII plus the four arrow keys
+
 class GraphObject;
 class GameWorld;
+class SoftRasterizer;
+class SoftFramebuffer;
 
 class GameController
 {
   public:
+	GameController();
+	~GameController();
+
 	void run(GameWorld* gw, int testParams[], std::string windowTitle);
 
+	  // Take the oldest unconsumed key press, if any
 	bool getLastKey(int& value)
 	{
-		if (m_lastKeyHit != INVALID_KEY)
-		{
-			value = m_lastKeyHit;
-			m_lastKeyHit = INVALID_KEY;
-			return true;
-		}
-		return false;
+		long long timestamp;
+		return getLastKey(value, timestamp);
+	}
+
+	bool getLastKey(int& value, long long& timestamp)
+	{
+		InputEvent event;
+		if (!m_inputQueue.pop(event))
+			return false;
+		value = event.key;
+		timestamp = event.timestamp;
+		return true;
+	}
+
+	  // The world moved the player in response to the key press stamped
+	  // timestamp; the next presented frame closes the latency measurement.
+	void inputApplied(long long timestamp);
+
+	  // Look at the oldest unconsumed key press without taking it
+	bool peekKey(int& value) const
+	{
+		InputEvent event;
+		if (!m_inputQueue.peek(event))
+			return false;
+		value = event.key;
+		return true;
+	}
+
+	unsigned int getInputQueueDepth() const
+	{
+		return m_inputQueue.size();
+	}
+
+	unsigned int getMaxInputQueueDepth() const
+	{
+		return m_maxInputQueueDepth;
+	}
+
+	unsigned long long getDroppedInputEvents() const
+	{
+		return m_droppedInputEvents;
 	}
 
 	void keyboardEvent(unsigned char key, int x, int y);
+	void keyboardUpEvent(unsigned char key, int, int);
 	void specialKeyboardEvent(int key, int x, int y);
+	void specialKeyboardUpEvent(int key, int, int);
     
 	void playSound(int soundID);
 
@@ -54,21 +109,49 @@ class GameController
 private:
 
 	void initDrawersAndSounds();
+	void postKey(int key, bool pressed);
+	void changeVolume(float delta);
     void displayGamePlay();
+	void displayOpenGL(const std::string& overlayText);
+	void displaySoftware(const std::string& overlayText);
+	std::string inputLatencyText() const;
+	static void writeInputSummaryAtExit();
 
 	GameWorld*	m_gw;
 	GC_STATE	m_gameState;
 	GC_STATE	m_nextStateAfterPrompt;
-	int 		m_lastKeyHit;
+	SpscRing<InputEvent, INPUT_QUEUE_CAPACITY> m_inputQueue;
+	unsigned int       m_maxInputQueueDepth;
+	unsigned long long m_droppedInputEvents;
+	bool               m_keyHeld[NUM_KEY_SLOTS];
     bool        m_singleStep;
+	bool        m_softwareRendering;   // draw with SoftRasterizer instead of OpenGL
+	bool        m_showInputLatency;    // on-screen input latency readout
+	float       m_volume;              // sound volume, 0 to 1
+	long long   m_pendingInputTime;    // oldest applied key press not yet on screen (0 if none)
+	long long   m_lastInputLatency;
+	int         m_windowWidth;
+	int         m_windowHeight;
+	SoftRasterizer*  m_softRaster;
+	SoftFramebuffer* m_softFrame;
 	std::string	m_gameStatText;
 	std::string	m_mainMessage;
 	std::string	m_secondMessage;
 	int         m_curIntraFrameTick;
+	long long   m_tickStartTime;       // when the current tick's move() began (us)
+	double      m_tickFraction;        // how far through the tick the frame being drawn is
 	typedef std::map<int, std::string>           SoundMapType;
-	typedef std::map<int, void(*)(GraphObject*)> DrawMapType;
 	SoundMapType m_soundMap;
-	DrawMapType  m_drawMap;
+
+	  // Draw routines indexed by image ID, and that frame's visible objects
+	  // bucketed by image ID so each kind is drawn with one state setup
+	struct Drawer
+	{
+		void  (*draw)(GraphObject*);
+		float lineWidth;
+	};
+	Drawer                    m_drawers[NUM_IMAGE_IDS];
+	std::vector<GraphObject*> m_drawBuckets[NUM_IMAGE_IDS];
 };
 
 inline GameController& Game()
@@ -1,23 +1,102 @@
 #include "GameWorld.h"
 #include "GameController.h"
+#include "Snapshot.h"
+#include "Metrics.h"
+#include "OfflineAudio.h"
 #include <string>
 #include <cstdlib>
 using namespace std;
 
+GameWorld::GameWorld()
+ : m_lives(START_PLAYER_LIVES), m_score(0), m_controller(NULL),
+   m_randState(rand()), m_metrics(Metrics().acquireShard()), m_audio(NULL)
+{
+	for (int i = 0; i < NUM_TEST_PARAMS; i++)
+		m_testParams[i] = 0;
+	for (int p = 0; p < MAX_PLAYERS; p++)
+		m_firstInjectedKey[p] = m_numInjectedKeys[p] = 0;
+}
+
+GameWorld::~GameWorld()
+{
+	Metrics().releaseShard(m_metrics);
+}
+
 bool GameWorld::getKey(int& value)
 {
-	bool result = m_controller->getLastKey(value);
+	long long timestamp;
+	return getKey(value, timestamp);
+}
+
+bool GameWorld::getKey(int& value, long long& timestamp, int player)
+{
+	if (isHeadless() || player != 0)
+	{
+		if (!peekKey(value, player))
+			return false;
+		m_firstInjectedKey[player] = (m_firstInjectedKey[player] + 1) % MAX_INJECTED_KEYS;
+		m_numInjectedKeys[player]--;
+		timestamp = 0;
+		return true;
+	}
+	bool result = m_controller->getLastKey(value, timestamp);
 	if (value == 'q'  ||  value == '\x03')  // CTRL-C
 		exit(0);
 	return result;
 }
 
+void GameWorld::inputApplied(long long timestamp)
+{
+	if (!isHeadless())
+		m_controller->inputApplied(timestamp);
+}
+
+bool GameWorld::peekKey(int& value, int player)
+{
+	if (isHeadless() || player != 0)
+	{
+		if (m_numInjectedKeys[player] == 0)
+			return false;
+		value = m_injectedKeys[player][m_firstInjectedKey[player]];
+		return true;
+	}
+	return m_controller->peekKey(value);
+}
+
+bool GameWorld::injectKey(int key, int player)
+{
+	if (m_numInjectedKeys[player] == MAX_INJECTED_KEYS)
+		return false;
+	m_injectedKeys[player][(m_firstInjectedKey[player] + m_numInjectedKeys[player]) % MAX_INJECTED_KEYS] = key;
+	m_numInjectedKeys[player]++;
+	return true;
+}
+
 void GameWorld::playSound(int soundID)
 {
-	m_controller->playSound(soundID);
+	metricsAdd(m_metrics, METRIC_SOUNDS);
+	if (!isHeadless())
+		m_controller->playSound(soundID);
+	else if (m_audio != NULL)
+		m_audio->soundPlayed(soundID);
 }
 
 void GameWorld::setGameStatText(string text)
 {
-	m_controller->setGameStatText(text);
+	if (!isHeadless())
+		m_controller->setGameStatText(text);
+}
+
+void GameWorld::saveWorldState(SnapshotWriter& w) const
+{
+	w.putUnsigned(m_lives);
+	w.putUnsigned(m_score);
+	w.putUnsigned(m_randState);
+}
+
+void GameWorld::loadWorldState(SnapshotReader& r)
+{
+	m_lives = r.getUnsigned();
+	m_score = r.getUnsigned();
+	m_randState = r.getUnsigned();
 }
@@ -5,21 +5,24 @@
 #include <string>
 
 const int START_PLAYER_LIVES = 3;
+const int MAX_INJECTED_KEYS = 8;
+const int MAX_PLAYERS = 2;          // ships a world can have, each with its own keys
 
 class GameController;
+class StarField;
+class EffectPool;
+class SnapshotWriter;
+class SnapshotReader;
+class MetricsShard;
+class OfflineAudioRenderer;
+class ActorStats;
 
 class GameWorld
 {
 public:
 
-	GameWorld()
-     : m_lives(START_PLAYER_LIVES), m_score(0), m_controller(NULL)
-	{
-	}
-
-	virtual ~GameWorld()
-	{
-	}
+	GameWorld();
+	virtual ~GameWorld();
 	
 	virtual void init() = 0;
 	virtual int move() = 0;
@@ -56,7 +59,38 @@ public:
 		m_score += howMuch;
 	}
 
+	  // Background stars to draw, if the world has any
+	virtual const StarField* getStarField() const
+	{
+		return NULL;
+	}
+
+	  // Debris particles to draw, if the world has any
+	virtual const EffectPool* getEffects() const
+	{
+		return NULL;
+	}
+
+	  // Per-type actor allocation counts, if the world keeps any
+	virtual const ActorStats* getActorStats() const
+	{
+		return NULL;
+	}
+
+	  // Random integer in [0, n), from a generator private to this world so
+	  // that a seeded world plays out the same way every time
+	int randInt(int n)
+	{
+		m_randState = m_randState * 1103515245u + 12345u;
+		return int((m_randState >> 16) & 0x7fff) % n;
+	}
+
+	  // Keys for player 0 come from the controller or injectKey(); keys for
+	  // the second player only ever come from injectKey()
 	bool getKey(int& value);
+	bool getKey(int& value, long long& timestamp, int player = 0);
+	void inputApplied(long long timestamp);
+	bool peekKey(int& value, int player = 0);
 	void playSound(int soundID);
     
     bool testParamsProvided() const
@@ -80,6 +114,42 @@ public:
 	{
 		m_controller = controller;
 	}
+
+	  // A world without a controller runs headless: keys come only from
+	  // injectKey(), sounds are dropped (or go to an offline renderer) and
+	  // no status text is built.
+	bool isHeadless() const
+	{
+		return m_controller == NULL;
+	}
+
+	  // This world's metrics counters, or NULL if metrics are off
+	MetricsShard* getMetrics() const
+	{
+		return m_metrics;
+	}
+
+	  // Where a headless world's sounds go instead of being dropped
+	void setAudioRenderer(OfflineAudioRenderer* renderer)
+	{
+		m_audio = renderer;
+	}
+
+	bool injectKey(int key, int player = 0);
+	void clearInjectedKeys()
+	{
+		for (int p = 0; p < MAX_PLAYERS; p++)
+			m_numInjectedKeys[p] = 0;
+	}
+
+	void seedRandom(unsigned int seed)
+	{
+		m_randState = seed;
+	}
+
+	  // Lives, score and random state; subclasses add their own
+	void saveWorldState(SnapshotWriter& w) const;
+	void loadWorldState(SnapshotReader& r);
     
 	void setTestParams(int testParams[])
 	{
@@ -92,6 +162,12 @@ private:
 	unsigned int	m_score;
 	GameController* m_controller;
 	int				m_testParams[NUM_TEST_PARAMS];
+	unsigned int	m_randState;
+	int				m_injectedKeys[MAX_PLAYERS][MAX_INJECTED_KEYS];
+	int				m_firstInjectedKey[MAX_PLAYERS];
+	int				m_numInjectedKeys[MAX_PLAYERS];
+	MetricsShard*	m_metrics;
+	OfflineAudioRenderer* m_audio;
 };
 
 #endif // _GAMEWORLD_H_
@@ -5,6 +5,8 @@
 #include <cmath>
  
 const int ANIMATION_POSITIONS_PER_TICK = 3;
+const int MS_PER_FRAME = 10;
+const int MS_PER_TICK  = MS_PER_FRAME * (ANIMATION_POSITIONS_PER_TICK + 1);
 
 inline int roundAwayFromZero(double r)
 {
@@ -18,15 +20,17 @@ class GraphObject
   public:
 	GraphObject(int imageID, int startX, int startY)
 	 : m_imageID(imageID), m_visible(false), m_x(startX), m_y(startY),
-	   m_destX(startX), m_destY(startY), m_brightness(1.0),
-	   m_animationNumber(0)
+	   m_prevX(startX), m_prevY(startY), m_destX(startX), m_destY(startY),
+	   m_brightness(1.0), m_animationNumber(0), m_registered(registryEnabled())
 	{
-		getGraphObjects().insert(this);
+		if (m_registered)
+			getGraphObjects().insert(this);
 	}
 
 	virtual ~GraphObject()
 	{
-		getGraphObjects().erase(this);
+		if (m_registered)
+			getGraphObjects().erase(this);
 	}
 
 	void setVisible(bool shouldIDisplay)
@@ -85,11 +89,25 @@ class GraphObject
 		y = m_y;
 	}
 
-	void animate()
+	  // Called just before each tick: the object will be drawn moving from
+	  // where it is now toward wherever the tick moves it.
+	void beginTick()
 	{
+		m_prevX = m_destX;
+		m_prevY = m_destY;
+	}
+
+	  // Place the object tickFraction (0..1) of the way through the current
+	  // tick's move, so motion follows elapsed time rather than frame count.
+	void animate(double tickFraction)
+	{
+		if (tickFraction < 0)
+			tickFraction = 0;
+		else if (tickFraction > 1)
+			tickFraction = 1;
 		m_animationNumber++;
-		moveALittle(m_x, m_destX);
-		moveALittle(m_y, m_destY);
+		m_x = m_prevX + (m_destX - m_prevX) * tickFraction;
+		m_y = m_prevY + (m_destY - m_prevY) * tickFraction;
 	}
 
 	static std::set<GraphObject*>& getGraphObjects()
@@ -98,7 +116,20 @@ class GraphObject
 		return graphObjects;
 	}
 
+	  // Objects created while the registry is off are never drawn.  Headless
+	  // worlds turn it off so they need not share one global set.
+	static void setRegistryEnabled(bool enabled)
+	{
+		registryEnabled() = enabled;
+	}
+
   private:
+	static bool& registryEnabled()
+	{
+		static bool enabled = true;
+		return enabled;
+	}
+
 	  // Prevent copying or assigning GraphObjects
 	GraphObject(const GraphObject&);
 	GraphObject& operator=(const GraphObject&);
@@ -107,21 +138,13 @@ class GraphObject
 	bool   m_visible;
 	double m_x;
 	double m_y;
+	double m_prevX;
+	double m_prevY;
 	double m_destX;
 	double m_destY;
 	double m_brightness;
 	int    m_animationNumber;
-
-	void moveALittle(double& from, double& to)
-	{
-		static const double DISTANCE = 1.0/ANIMATION_POSITIONS_PER_TICK;
-		if (to - from >= DISTANCE)
-			from += DISTANCE;
-		else if (from - to >= DISTANCE)
-			from -= DISTANCE;
-		else
-			from = to;
-	}
+	bool   m_registered;
 };
 
 #endif // _GRAPHOBJ_H_
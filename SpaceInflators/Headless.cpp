@@ -0,0 +1,759 @@
+#include "Headless.h"
+#include "AgentEnv.h"
+#include "SpaceInflatorsC.h"
+#include "MonteCarlo.h"
+#include "StudentWorld.h"
+#include "GraphObject.h"
+#include "Telemetry.h"
+#include "SoundMixer.h"
+#include "OfflineAudio.h"
+#include "AgentPolicy.h"
+#include "StateStream.h"
+#include "SpectatorSocket.h"
+#include "Lockstep.h"
+#include "SoftRaster.h"
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <cstdlib>
+#include <vector>
+#include <thread>
+#include <chrono>
+using namespace std;
+
+namespace
+{
+	  // Random policy shared by the benchmarks so runs with one seed match
+	int randomAction(unsigned int& state)
+	{
+		state = state * 1103515245u + 12345u;
+		return int((state >> 16) & 0x7fff) % NUM_ACTIONS;
+	}
+
+	int runAgentBench(int steps, unsigned int seed)
+	{
+		AgentEnv env;
+		AgentObservation obs;
+		env.reset(seed, obs);
+
+		static unsigned char grid[GRID_SIZE];
+		unsigned int policyState = seed;   // the random policy's own generator
+		int games = 0;
+		long long totalScore = 0;
+		long long gridTime = 0;
+		long long start = Telemetry::now();
+		for (int k = 0; k < steps; k++)
+		{
+			AgentStepResult r = env.step(randomAction(policyState), obs);
+			long long gridStart = Telemetry::now();
+			env.observeGrid(grid);
+			gridTime += Telemetry::now() - gridStart;
+			if (r.done)
+			{
+				games++;
+				totalScore += obs.score;
+				env.reset(seed + games, obs);
+			}
+		}
+		long long elapsed = Telemetry::now() - start;
+
+		cout << steps << " steps in " << elapsed / 1000.0 << " ms ("
+		     << (elapsed > 0 ? steps * 1000000.0 / elapsed : 0) << " steps/s), "
+		     << games << " games finished";
+		if (games > 0)
+			cout << ", mean score " << double(totalScore) / games;
+		cout << endl;
+		cout << "Grid observation: " << (steps > 0 ? gridTime * 1000.0 / steps : 0) << " ns/step" << endl;
+		return 0;
+	}
+
+	  // Play the same seeded game through AgentEnv and through the C API and
+	  // compare the cost per step; then check that a snapshot taken half way
+	  // replays to the same final score.
+	int runCApiBench(int steps, unsigned int seed)
+	{
+		AgentEnv env;
+		AgentObservation obs;
+		env.reset(seed, obs);
+		unsigned int policyState = seed;
+		long long directScore = 0;
+		long long start = Telemetry::now();
+		for (int k = 0; k < steps; k++)
+		{
+			AgentStepResult r = env.step(randomAction(policyState), obs);
+			directScore += r.reward;
+			if (r.done)
+				env.reset(seed + k, obs);
+		}
+		long long directTime = Telemetry::now() - start;
+
+		si_world* world = si_create();
+		si_reset(world, seed);
+		policyState = seed;
+		long long cScore = 0;
+		vector<char> snapshot;
+		unsigned int policyAtSnapshot = 0;
+		long long scoreAtSnapshot = 0;
+		long long snapshotTime = 0;
+		start = Telemetry::now();
+		for (int k = 0; k < steps; k++)
+		{
+			if (k == steps / 2)
+			{
+				long long snapshotStart = Telemetry::now();
+				snapshot.resize(si_snapshot(world, NULL, 0));
+				si_snapshot(world, &snapshot[0], snapshot.size());
+				snapshotTime = Telemetry::now() - snapshotStart;
+				policyAtSnapshot = policyState;
+				scoreAtSnapshot = cScore;
+			}
+			int reward;
+			int flags = si_step(world, randomAction(policyState), &reward);
+			cScore += reward;
+			if (flags & SI_STEP_DONE)
+				si_reset(world, seed + k);
+		}
+		long long cTime = Telemetry::now() - start - snapshotTime;
+
+		long long restoreStart = Telemetry::now();
+		bool restored = si_restore(world, &snapshot[0], snapshot.size()) != 0;
+		long long restoreTime = Telemetry::now() - restoreStart;
+		policyState = policyAtSnapshot;
+		long long replayScore = scoreAtSnapshot;
+		for (int k = steps / 2; k < steps; k++)
+		{
+			int reward;
+			int flags = si_step(world, randomAction(policyState), &reward);
+			replayScore += reward;
+			if (flags & SI_STEP_DONE)
+				si_reset(world, seed + k);
+		}
+		si_destroy(world);
+
+		cout << "Direct: " << (steps > 0 ? directTime * 1000.0 / steps : 0) << " ns/step, C API: "
+		     << (steps > 0 ? cTime * 1000.0 / steps : 0) << " ns/step"
+		     << (directScore == cScore ? "" : " (SCORES DIFFER)") << endl;
+		cout << "Snapshot: " << snapshot.size() << " bytes, saved in " << snapshotTime << " us, restored in "
+		     << restoreTime << " us; replay " << (restored && replayScore == cScore ? "matches" : "DIFFERS") << endl;
+		return directScore == cScore && restored && replayScore == cScore ? 0 : 1;
+	}
+
+	  // Keys a random stress input picks from; KEY_PRESS_NONE stands for no key
+	const int KEY_PRESS_NONE = -1;
+	const int STRESS_KEYS[] = {
+		KEY_PRESS_NONE, KEY_PRESS_LEFT, KEY_PRESS_RIGHT, KEY_PRESS_UP, KEY_PRESS_DOWN,
+		KEY_PRESS_SPACE, KEY_PRESS_TAB
+	};
+	const int NUM_STRESS_KEYS = sizeof(STRESS_KEYS) / sizeof(STRESS_KEYS[0]);
+
+	  // Check that an alien bullet appearing on a ship costs it energy, the
+	  // way one fired point-blank from the row above does: it moves off the
+	  // ship in the tick it appears.  Checked on the starting row and on the
+	  // bottom row, where the bullet also leaves the board as it hits.
+	bool checkPointBlankShots(unsigned int seed, string& problem)
+	{
+		for (int row = 1; row >= 0; row--)
+		{
+			StudentWorld world;
+			world.seedRandom(seed);
+			world.init();
+			if (row == 0)
+			{
+				world.injectKey(KEY_PRESS_DOWN);
+				world.move();
+			}
+			const Player* player = world.getPlayer();
+			int energy = player->getEnergy();
+			if (player->getY() != row)
+			{
+				problem = "the player did not reach the bottom row";
+				return false;
+			}
+			new Bullet(&world, player->getX(), player->getY(), false);
+			world.move();
+			if (player->getEnergy() >= energy)
+			{
+				problem = row == 0 ? "a point-blank shot on the bottom row missed the player"
+				                   : "a point-blank shot missed the player";
+				return false;
+			}
+		}
+		return true;
+	}
+
+	  // Run seeded worlds on random input and check StudentWorld's invariants
+	  // after every tick, the same lifecycle the controller uses: init, move
+	  // until the player dies, cleanUp and init again until the game is over,
+	  // then cleanUp and delete.  Torpedo goodies are rare, so every new
+	  // player gets some torpedoes to keep the torpedo paths busy.  The
+	  // point-blank shot checks run first.
+	int runStress(long long ticks, unsigned int seed, bool thorough)
+	{
+		GraphObject::setRegistryEnabled(false);
+		unsigned int inputState = seed;
+		long long games = 0, checks = 0;
+		string problem;
+		if (!checkPointBlankShots(seed, problem))
+		{
+			cout << "Collision check failed (seed " << seed << "): " << problem << endl;
+			return 1;
+		}
+		StudentWorld* world = NULL;
+		long long start = Telemetry::now();
+		for (long long t = 0; t < ticks; t++)
+		{
+			if (world == NULL)
+			{
+				world = new StudentWorld;
+				world->seedRandom(seed + (unsigned int)games);
+				world->init();
+			}
+
+			  // Up to three keys a tick, so some stay queued for the next one
+			inputState = inputState * 1103515245u + 12345u;
+			int numKeys = (inputState >> 16) % 4;
+			for (int k = 0; k < numKeys; k++)
+			{
+				inputState = inputState * 1103515245u + 12345u;
+				int key = STRESS_KEYS[(inputState >> 16) % NUM_STRESS_KEYS];
+				if (key != KEY_PRESS_NONE)
+					world->injectKey(key);
+			}
+
+			unsigned int scoreBefore = world->getScore();
+			int roundBefore = world->getRound();
+			int status = world->move();
+			bool ok = world->checkInvariants(thorough, problem);
+			if (ok && (world->getScore() < scoreBefore || world->getRound() < roundBefore))
+			{
+				ok = false;
+				problem = "score or round went down";
+			}
+			checks++;
+			if (ok && status == GWSTATUS_PLAYER_DIED)
+			{
+				world->cleanUp();
+				ok = world->checkInvariants(thorough, problem);
+				if (world->isGameOver())
+				{
+					delete world;
+					world = NULL;
+					games++;
+				}
+				else
+					world->init();
+			}
+			if (!ok)
+			{
+				cout << "Invariant failed at tick " << t << " of game " << games
+				     << " (seed " << seed + games << "): " << problem << endl;
+				delete world;
+				return 1;
+			}
+		}
+		delete world;
+		long long elapsed = Telemetry::now() - start;
+
+		cout << ticks << " ticks (" << games << " games) checked " << (thorough ? "thoroughly" : "cheaply")
+		     << " in " << elapsed / 1000.0 << " ms (" << (elapsed > 0 ? ticks * 1000000.0 / elapsed : 0)
+		     << " ticks/s); all invariants held" << endl;
+		return 0;
+	}
+
+	  // Draw a scripted session with the software rasterizer at the game
+	  // window's size and time softRenderFrame.  The checksum of the last
+	  // frame should not depend on the thread count.
+	int runRasterBench(int frames, int threads, unsigned int seed)
+	{
+		const int width = 1024, height = 768;   // GameController's window
+		AgentPolicy* policy = createAgentPolicy("hunter");
+		AgentEnv env;
+		GraphObject::setRegistryEnabled(true);   // softRenderFrame draws what is registered
+		AgentObservation obs;
+		SoftRasterizer raster;
+		raster.setThreadCount(threads);
+		SoftFramebuffer fb(width, height);
+		int games = 0;
+		long long renderTime = 0, pixels = 0;
+		env.reset(seed, obs);
+		policy->reset(seed);
+		for (int f = 0; f < frames; f++)
+		{
+			if (env.step(policy->chooseAction(obs), obs).done)
+			{
+				games++;
+				env.reset(seed + games, obs);
+				policy->reset(seed + games);
+			}
+			const StudentWorld& world = *env.getWorld();
+			long long start = Telemetry::now();
+			softRenderFrame(raster, fb, GraphObject::getGraphObjects(), world.getStarField(), world.getEffects(),
+			                "Score: 0001234  Level: 01  Lives: 3  Health: 100%  Torpedoes: 0", 1);
+			renderTime += Telemetry::now() - start;
+			pixels += raster.getPixelsWritten();
+		}
+		delete policy;
+
+		unsigned int checksum = 2166136261u;
+		for (int k = 0; k < width * height; k++)
+			checksum = (checksum ^ fb.getPixels()[k]) * 16777619u;
+		cout << frames << " frames at " << width << "x" << height << " on " << threads << " thread"
+		     << (threads == 1 ? "" : "s") << ": " << (frames > 0 ? renderTime * 1000.0 / frames : 0)
+		     << " ns/frame, " << (frames > 0 ? pixels / frames : 0) << " pixels written per frame, "
+		     << "last frame checksum " << hex << checksum << dec << endl;
+		return 0;
+	}
+
+	  // Play the same seeded games under each dispatch mode on random input
+	  // and time move().  The score total shows the virtual and switch modes
+	  // play identical games; grouping changes the update order.
+	int runDispatchBench(long long ticks, unsigned int seed)
+	{
+		GraphObject::setRegistryEnabled(false);
+		const DispatchMode modes[] = { DISPATCH_VIRTUAL, DISPATCH_SWITCH, DISPATCH_GROUPED };
+		const char* const names[] = { "virtual", "switch", "grouped" };
+		long long scores[3];
+		for (int m = 0; m < 3; m++)
+		{
+			unsigned int inputState = seed;
+			long long games = 0, actorUpdates = 0, moveTime = 0;
+			scores[m] = 0;
+			StudentWorld* world = NULL;
+			for (long long t = 0; t < ticks; t++)
+			{
+				if (world == NULL)
+				{
+					world = new StudentWorld;
+					world->seedRandom(seed + (unsigned int)games);
+					world->setDispatchMode(modes[m]);
+					world->init();
+				}
+				world->clearInjectedKeys();
+				world->injectKey(STRESS_KEYS[1 + randomAction(inputState) % (NUM_STRESS_KEYS - 1)]);
+				actorUpdates += world->getActors().size();
+				long long moveStart = Telemetry::now();
+				int status = world->move();
+				moveTime += Telemetry::now() - moveStart;
+				if (status == GWSTATUS_PLAYER_DIED)
+				{
+					world->cleanUp();
+					if (world->isGameOver())
+					{
+						scores[m] += world->getScore();
+						delete world;
+						world = NULL;
+						games++;
+					}
+					else
+						world->init();
+				}
+			}
+			if (world != NULL)
+				scores[m] += world->getScore();
+			delete world;
+			cout << left << setw(8) << names[m] << right << " " << (ticks > 0 ? moveTime * 1000.0 / ticks : 0)
+			     << " ns/tick, " << (actorUpdates > 0 ? moveTime * 1000.0 / actorUpdates : 0)
+			     << " ns/actor, " << games << " games, score total " << scores[m] << endl;
+		}
+		cout << "virtual and switch " << (scores[0] == scores[1] ? "played the same games" : "DIFFER") << endl;
+		return scores[0] == scores[1] ? 0 : 1;
+	}
+
+	  // Decode the game's clips and time the mixer on 10 ms blocks with the
+	  // given number of voices kept busy
+	int runMixBench(int blocks, int voices)
+	{
+		const char* files[] = {
+			"theme.wav", "explode2.wav", "laser.wav", "goodie.wav", "clank.wav",
+			"damage.wav", "explode.wav", "torpedo.wav"
+		};
+		const int numFiles = sizeof(files) / sizeof(files[0]);
+		vector<SoundClip> clips(numFiles);
+		long long decodeTime = 0;
+		for (int k = 0; k < numFiles; k++)
+		{
+			ifstream in(files[k], ios::binary);
+			vector<char> data((istreambuf_iterator<char>(in)), istreambuf_iterator<char>());
+			long long start = Telemetry::now();
+			bool ok = !data.empty() && decodeWav(&data[0], data.size(), clips[k]);
+			decodeTime += Telemetry::now() - start;
+			if (!ok)
+			{
+				cout << "Cannot decode " << files[k] << " (run from the directory with the clips)" << endl;
+				return 1;
+			}
+		}
+
+		SoundMixer mixer;
+		if (voices > SoundMixer::MAX_VOICES)
+			voices = SoundMixer::MAX_VOICES;
+		static short block[MIXER_BLOCK * MIXER_CHANNELS];
+		int next = 0;
+		LatencyHistogram blockTimes;
+		long long start = Telemetry::now();
+		for (int b = 0; b < blocks; b++)
+		{
+			while (mixer.getNumVoices() < voices)
+				mixer.play(&clips[next++ % numFiles]);
+			long long blockStart = Telemetry::now();
+			mixer.mix(block, MIXER_BLOCK);
+			blockTimes.record(Telemetry::now() - blockStart);
+		}
+		long long elapsed = Telemetry::now() - start;
+
+		cout << numFiles << " clips decoded in " << decodeTime / 1000.0 << " ms" << endl;
+		cout << blocks << " blocks of " << MIXER_BLOCK << " frames with " << voices << " voices: "
+		     << (blocks > 0 ? elapsed * 1000.0 / blocks : 0) << " ns per 10 ms block" << endl;
+		blockTimes.writeSummary(cout, "mix block");
+		return 0;
+	}
+
+	  // Play seeded games with a scripted policy and render their sounds to
+	  // a WAV file; the checksum is the same for the same arguments
+	int runRenderAudio(const string& path, long long ticks, unsigned int seed, const string& policyName)
+	{
+		AgentPolicy* policy = createAgentPolicy(policyName);
+		if (policy == NULL)
+		{
+			cout << "Unknown policy " << policyName << "; choose from " << agentPolicyNames() << endl;
+			return 1;
+		}
+		int result = 1;
+		{
+			OfflineAudioRenderer renderer;
+			if (renderer.open(path))
+			{
+				AgentEnv env;
+				env.setAudioRenderer(&renderer);
+				AgentObservation obs;
+				int games = 0;
+				env.reset(seed, obs);
+				policy->reset(seed);
+				long long start = Telemetry::now();
+				for (long long t = 0; t < ticks; t++)
+				{
+					if (env.step(policy->chooseAction(obs), obs).done)
+					{
+						games++;
+						env.reset(seed + games, obs);
+						policy->reset(seed + games);
+					}
+				}
+				long long elapsed = Telemetry::now() - start;
+				double audioSeconds = ticks * MS_PER_TICK / 1000.0;
+				cout << ticks << " ticks (" << audioSeconds << " s of audio, " << renderer.getEvents()
+				     << " sounds) rendered in " << elapsed / 1000.0 << " ms, "
+				     << (elapsed > 0 ? audioSeconds * 1e6 / elapsed : 0) << "x real time" << endl;
+				cout << "Checksum " << hex << renderer.getChecksum() << dec << endl;
+				result = 0;
+			}
+		}
+		delete policy;
+		return result;
+	}
+
+	const int SPECTATOR_KEYFRAME_INTERVAL = 50;   // two seconds of play
+
+	  // Play seeded games with a scripted policy at the windowed game's
+	  // speed, publishing every tick to spectators at path
+	int runSpectate(const string& path, long long ticks, unsigned int seed, const string& policyName)
+	{
+		AgentPolicy* policy = createAgentPolicy(policyName);
+		if (policy == NULL)
+		{
+			cout << "Unknown policy " << policyName << "; choose from " << agentPolicyNames() << endl;
+			return 1;
+		}
+		SpectatorServer server;
+		if (!server.open(path))
+		{
+			delete policy;
+			return 1;
+		}
+		cout << "Publishing to " << path << "; watch with --watch " << path << endl;
+
+		AgentEnv env;
+		AgentObservation obs;
+		StateEncoder encoder(SPECTATOR_KEYFRAME_INTERVAL);
+		vector<unsigned char> frame;
+		int games = 0, spectators = 0;
+		env.reset(seed, obs);
+		policy->reset(seed);
+		chrono::steady_clock::time_point next = chrono::steady_clock::now();
+		for (long long t = 0; t < ticks; t++)
+		{
+			int joined = server.acceptSpectators();
+			if (joined > 0)
+			{
+				spectators += joined;
+				encoder.requestKeyframe();
+			}
+			if (env.step(policy->chooseAction(obs), obs).done)
+			{
+				games++;
+				env.reset(seed + games, obs);
+				policy->reset(seed + games);
+			}
+			encoder.encode(*env.getWorld(), frame);
+			server.publish(frame, encoder.lastWasKeyframe());
+			next += chrono::milliseconds(MS_PER_TICK);
+			this_thread::sleep_until(next);
+		}
+		cout << ticks << " ticks, " << games << " games finished, " << spectators << " spectators, "
+		     << server.getBytesSent() << " bytes sent, " << server.getNumDisconnected() << " disconnected" << endl;
+		delete policy;
+		return 0;
+	}
+
+	  // Follow a --spectate session, printing the status about once a second
+	int runWatch(const string& path)
+	{
+		SpectatorClient client;
+		if (!client.connect(path))
+			return 1;
+		StateDecoder decoder;
+		vector<unsigned char> frame;
+		long long frames = 0, bytes = 0;
+		while (client.receive(frame))
+		{
+			if (!decoder.apply(frame.empty() ? NULL : &frame[0], frame.size()))
+			{
+				cout << "Bad frame after " << frames << " frames" << endl;
+				return 1;
+			}
+			frames++;
+			bytes += frame.size();
+			if (frames % (1000 / MS_PER_TICK) == 0)
+			{
+				const StreamFields& f = decoder.getFields();
+				cout << "tick " << f.tick << "  score " << f.score << "  lives " << f.lives
+				     << "  round " << f.round << "  " << decoder.getEntities().size() << " entities  "
+				     << bytes / frames << " bytes/frame" << endl;
+			}
+		}
+		cout << frames << " frames, " << bytes << " bytes; stream ended" << endl;
+		return 0;
+	}
+
+	  // Compare the per-tick cost of the spectator stream with keyframes only
+	  // and with the full snapshot AgentEnv saves, and check that decoding the
+	  // stream rebuilds the world every tick
+	int runStreamBench(long long ticks, unsigned int seed)
+	{
+		AgentPolicy* policy = createAgentPolicy("hunter");
+		AgentEnv env;
+		AgentObservation obs;
+		StateEncoder deltas(SPECTATOR_KEYFRAME_INTERVAL);
+		StateEncoder keyframes(1);
+		StateDecoder decoder;
+		vector<unsigned char> frame;
+		vector<char> snapshot(1 << 16);
+		long long deltaBytes = 0, keyBytes = 0, snapshotBytes = 0;
+		long long deltaTime = 0, keyTime = 0, snapshotTime = 0, decodeTime = 0;
+		bool matches = true;
+		int games = 0;
+		env.reset(seed, obs);
+		policy->reset(seed);
+		for (long long t = 0; t < ticks; t++)
+		{
+			if (env.step(policy->chooseAction(obs), obs).done)
+			{
+				games++;
+				env.reset(seed + games, obs);
+				policy->reset(seed + games);
+			}
+			const StudentWorld& world = *env.getWorld();
+
+			long long start = Telemetry::now();
+			keyframes.encode(world, frame);
+			keyTime += Telemetry::now() - start;
+			keyBytes += frame.size();
+
+			start = Telemetry::now();
+			size_t size = env.saveSnapshot(&snapshot[0], snapshot.size());
+			snapshotTime += Telemetry::now() - start;
+			if (size > snapshot.size())
+			{
+				snapshot.resize(size * 2);
+				size = env.saveSnapshot(&snapshot[0], snapshot.size());
+			}
+			snapshotBytes += size;
+
+			start = Telemetry::now();
+			deltas.encode(world, frame);
+			deltaTime += Telemetry::now() - start;
+			deltaBytes += frame.size();
+
+			start = Telemetry::now();
+			bool ok = decoder.apply(&frame[0], frame.size());
+			decodeTime += Telemetry::now() - start;
+			if (!ok || !(decoder.getEntities() == deltas.getEntities()) ||
+			    decoder.getFields().score != deltas.getFields().score ||
+			    decoder.getFields().torpedoes != deltas.getFields().torpedoes)
+				matches = false;
+		}
+		delete policy;
+
+		double n = ticks > 0 ? double(ticks) : 1;
+		cout << fixed << setprecision(1);
+		cout << ticks << " ticks, " << games << " games finished" << endl;
+		cout << "Delta stream (keyframe every " << SPECTATOR_KEYFRAME_INTERVAL << "): " << deltaBytes / n
+		     << " bytes/tick, encode " << deltaTime * 1000.0 / n << " ns/tick, decode "
+		     << decodeTime * 1000.0 / n << " ns/tick" << endl;
+		cout << "Keyframes only:               " << keyBytes / n << " bytes/tick, encode "
+		     << keyTime * 1000.0 / n << " ns/tick" << endl;
+		cout << "Full snapshot:                " << snapshotBytes / n << " bytes/tick, save "
+		     << snapshotTime * 1000.0 / n << " ns/tick" << endl;
+		cout << "Decoded stream " << (matches ? "matches the world" : "DIFFERS from the world") << endl;
+		return matches ? 0 : 1;
+	}
+
+	  // Play one side of a two-player lockstep game at the windowed game's
+	  // speed, with random input for this side's ship.  The host chooses the
+	  // ticks, input delay and seed; latency and jitter are this side's own.
+	int runLockstep(bool isHost, const string& path, int ticks, int delay, int latency, int jitter, unsigned int seed)
+	{
+		LockstepLink link;
+		if (isHost ? !link.host(path) : !link.join(path))
+			return 1;
+		LockstepMessage hello = { LockstepMessage::HELLO, ticks, delay, seed };
+		if (isHost)
+			link.send(hello);
+		else if (!link.receive(hello, 5000) || hello.type != LockstepMessage::HELLO)
+		{
+			cout << "No game offered at " << path << endl;
+			return 1;
+		}
+		ticks = hello.tick;
+		delay = hello.value;
+		seed = hello.hash;
+		int player = isHost ? 0 : 1;
+		link.setLatency(latency, jitter, seed + player);
+		cout << "Player " << player + 1 << ": " << ticks << " ticks, seed " << seed << ", input delay "
+		     << delay << " ticks, latency " << latency << "+" << jitter << " ms" << endl;
+
+		LockstepSession session(link, player, delay, seed);
+		unsigned int inputState = seed * 2 + player;
+		chrono::steady_clock::time_point next = chrono::steady_clock::now();
+		int status = GWSTATUS_CONTINUE_GAME;
+		while (session.getTick() < ticks && !session.isGameOver())
+		{
+			status = session.tick(randomAction(inputState));
+			if (status < 0)
+				break;
+			if (session.getTick() % 250 == 0)
+				cout << "tick " << session.getTick() << "  score " << session.getWorld().getScore()
+				     << "  lives " << session.getWorld().getLives() << "  hash " << hex << session.getHash()
+				     << dec << endl;
+			  // A tick that waited on the peer is not made up for later
+			next += chrono::milliseconds(MS_PER_TICK);
+			chrono::steady_clock::time_point now = chrono::steady_clock::now();
+			if (next < now)
+				next = now;
+			this_thread::sleep_until(next);
+		}
+		link.drain();   // the peer may still need our last inputs
+
+		cout << session.getTick() << " ticks, score " << session.getWorld().getScore() << ", final hash "
+		     << hex << session.getHash() << dec << endl;
+		cout << session.getHashesCompared() << " ticks' hashes compared with the peer; waited on "
+		     << session.getStalledTicks() << " ticks for " << session.getStallTime() / 1000.0 << " ms" << endl;
+		if (session.getDesyncTick() >= 0)
+		{
+			cout << "DESYNC at tick " << session.getDesyncTick() << endl;
+			return 1;
+		}
+		if (status < 0)
+		{
+			cout << "Lost the peer" << endl;
+			return 1;
+		}
+		return 0;
+	}
+}
+
+int runHeadless(int argc, char* argv[])
+{
+	if (argc < 2)
+		return -1;
+	string mode = argv[1];
+	if (mode == "--agent-bench")
+	{
+		int steps = argc > 2 ? atoi(argv[2]) : 1000000;
+		unsigned int seed = argc > 3 ? (unsigned int)(atoi(argv[3])) : 1;
+		return runAgentBench(steps, seed);
+	}
+	if (mode == "--capi-bench")
+	{
+		int steps = argc > 2 ? atoi(argv[2]) : 1000000;
+		unsigned int seed = argc > 3 ? (unsigned int)(atoi(argv[3])) : 1;
+		return runCApiBench(steps, seed);
+	}
+	if (mode == "--stress")
+	{
+		long long ticks = argc > 2 ? atoll(argv[2]) : 100000000;
+		unsigned int seed = argc > 3 ? (unsigned int)(atoi(argv[3])) : 1;
+		bool thorough = !(argc > 4 && string(argv[4]) == "cheap");
+		return runStress(ticks, seed, thorough);
+	}
+	if (mode == "--montecarlo")
+	{
+		string policy = argc > 2 ? argv[2] : "hunter";
+		long long games = argc > 3 ? atoll(argv[3]) : 100000;
+		unsigned int seed = argc > 4 ? (unsigned int)(atoi(argv[4])) : 1;
+		int threads = argc > 5 ? atoi(argv[5]) : 0;
+		return runMonteCarlo(policy, games, seed, threads, cout);
+	}
+	if (mode == "--render-audio" && argc > 2)
+	{
+		long long ticks = argc > 3 ? atoll(argv[3]) : 10000;
+		unsigned int seed = argc > 4 ? (unsigned int)(atoi(argv[4])) : 1;
+		string policy = argc > 5 ? argv[5] : "hunter";
+		return runRenderAudio(argv[2], ticks, seed, policy);
+	}
+	if (mode == "--raster-bench")
+	{
+		int frames = argc > 2 ? atoi(argv[2]) : 2000;
+		int threads = argc > 3 ? atoi(argv[3]) : int(thread::hardware_concurrency());
+		unsigned int seed = argc > 4 ? (unsigned int)(atoi(argv[4])) : 1;
+		return runRasterBench(frames, threads > 0 ? threads : 1, seed);
+	}
+	if (mode == "--dispatch-bench")
+	{
+		long long ticks = argc > 2 ? atoll(argv[2]) : 1000000;
+		unsigned int seed = argc > 3 ? (unsigned int)(atoi(argv[3])) : 1;
+		return runDispatchBench(ticks, seed);
+	}
+	if (mode == "--mix-bench")
+	{
+		int blocks = argc > 2 ? atoi(argv[2]) : 100000;
+		int voices = argc > 3 ? atoi(argv[3]) : SoundMixer::MAX_VOICES;
+		return runMixBench(blocks, voices);
+	}
+	if (mode == "--spectate" && argc > 2)
+	{
+		long long ticks = argc > 3 ? atoll(argv[3]) : 1000000000;
+		unsigned int seed = argc > 4 ? (unsigned int)(atoi(argv[4])) : 1;
+		string policy = argc > 5 ? argv[5] : "hunter";
+		return runSpectate(argv[2], ticks, seed, policy);
+	}
+	if (mode == "--watch" && argc > 2)
+		return runWatch(argv[2]);
+	if ((mode == "--lockstep-host" || mode == "--lockstep-join") && argc > 2)
+	{
+		int ticks = argc > 3 ? atoi(argv[3]) : 1500;
+		int delay = argc > 4 ? atoi(argv[4]) : 3;
+		int latency = argc > 5 ? atoi(argv[5]) : 0;
+		int jitter = argc > 6 ? atoi(argv[6]) : 0;
+		unsigned int seed = argc > 7 ? (unsigned int)(atoi(argv[7])) : 1;
+		return runLockstep(mode == "--lockstep-host", argv[2], ticks, delay, latency, jitter, seed);
+	}
+	if (mode == "--stream-bench")
+	{
+		long long ticks = argc > 2 ? atoll(argv[2]) : 1000000;
+		unsigned int seed = argc > 3 ? (unsigned int)(atoi(argv[3])) : 1;
+		return runStreamBench(ticks, seed);
+	}
+	return -1;
+}
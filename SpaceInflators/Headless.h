@@ -0,0 +1,47 @@
+#ifndef _HEADLESS_H_
+#define _HEADLESS_H_
+
+// Command-line modes that play the game with no window or sound.  If
+// argv[1] names one of them, runs it and returns the process exit code;
+// otherwise returns -1 and the windowed game should start as usual.
+//
+//   --agent-bench [steps] [seed]   time AgentEnv::step() and observeGrid()
+//                                  with random actions
+//   --capi-bench [steps] [seed]    compare the C API's cost per step with
+//                                  AgentEnv's and check snapshot replay
+//   --stress [ticks] [seed] [cheap]
+//                                  check that point-blank alien shots hit,
+//                                  then play on random input, checking the
+//                                  world's invariants after every tick
+//   --montecarlo [policy] [games] [seed] [threads]
+//                                  per-round difficulty statistics from
+//                                  many games played by a scripted policy
+//   --raster-bench [frames] [threads] [seed]
+//                                  time the software rasterizer drawing a
+//                                  scripted session with threads band
+//                                  workers (default: one per core)
+//   --dispatch-bench [ticks] [seed]
+//                                  time move() with virtual, switch and
+//                                  grouped actor dispatch
+//   --render-audio FILE [ticks] [seed] [policy]
+//                                  render a scripted session's sounds to
+//                                  a WAV file and print its checksum
+//   --mix-bench [blocks] [voices]  decode the clips and time the built-in
+//                                  mixer per 10 ms block
+//   --spectate SOCKET [ticks] [seed] [policy]
+//                                  play a scripted session in real time,
+//                                  streaming its state to spectators over
+//                                  a Unix domain socket
+//   --watch SOCKET                 follow a --spectate session
+//   --stream-bench [ticks] [seed]  compare the spectator stream's size and
+//                                  cost per tick with full snapshots
+//   --lockstep-host SOCKET [ticks] [delay] [latency] [jitter] [seed]
+//   --lockstep-join SOCKET [ticks] [delay] [latency] [jitter] [seed]
+//                                  play one side of a two-player game
+//                                  kept in step with the other process by
+//                                  exchanging inputs; the host's ticks,
+//                                  delay and seed are used, while latency
+//                                  and jitter (ms) delay this side's sends
+int runHeadless(int argc, char* argv[]);
+
+#endif // _HEADLESS_H_
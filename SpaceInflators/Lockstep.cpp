@@ -0,0 +1,401 @@
+#include "Lockstep.h"
+#include "StudentWorld.h"
+#include "AgentEnv.h"
+#include "GraphObject.h"
+#include "Snapshot.h"
+#include "Telemetry.h"
+#include <iostream>
+#include <cstring>
+#include <thread>
+#include <chrono>
+#ifndef _WIN32
+#include <csignal>
+#include <cerrno>
+#include <unistd.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#endif
+using namespace std;
+
+namespace
+{
+	const int JOIN_TIMEOUT_MS = 5000;    // how long join() waits for the host to listen
+	const int STALL_TIMEOUT_MS = 10000;  // how long a tick waits for the peer
+	const int HASHES_KEPT = 256;         // ticks of our hashes kept for comparison
+
+	void putWord(unsigned char* p, unsigned int v)
+	{
+		for (int k = 0; k < 4; k++)
+			p[k] = (unsigned char)(v >> (8 * k));
+	}
+
+	unsigned int getWord(const unsigned char* p)
+	{
+		return p[0] | (p[1] << 8) | (p[2] << 16) | ((unsigned int)p[3] << 24);
+	}
+}
+
+// LockstepLink
+
+#ifdef _WIN32
+
+LockstepLink::LockstepLink()
+ : m_fd(-1), m_listenFd(-1), m_latency(0), m_jitter(0), m_jitterState(1), m_broken(true)
+{
+}
+
+LockstepLink::~LockstepLink()
+{
+}
+
+bool LockstepLink::host(const string& path)
+{
+	cerr << "Lockstep play needs Unix domain sockets" << endl;
+	return false;
+}
+
+bool LockstepLink::join(const string& path)
+{
+	cerr << "Lockstep play needs Unix domain sockets" << endl;
+	return false;
+}
+
+void LockstepLink::pump()
+{
+}
+
+bool LockstepLink::receive(LockstepMessage& message, int timeoutMs)
+{
+	return false;
+}
+
+#else
+
+namespace
+{
+	#ifndef MSG_NOSIGNAL
+	const int MSG_NOSIGNAL = 0;   // SIGPIPE is ignored instead
+	#endif
+
+	bool makeAddress(const string& path, sockaddr_un& address)
+	{
+		memset(&address, 0, sizeof(address));
+		address.sun_family = AF_UNIX;
+		if (path.size() >= sizeof(address.sun_path))
+		{
+			cerr << "Socket path too long: " << path << endl;
+			return false;
+		}
+		strcpy(address.sun_path, path.c_str());
+		return true;
+	}
+}
+
+LockstepLink::LockstepLink()
+ : m_fd(-1), m_listenFd(-1), m_latency(0), m_jitter(0), m_jitterState(1), m_broken(true)
+{
+}
+
+LockstepLink::~LockstepLink()
+{
+	if (m_fd >= 0)
+		close(m_fd);
+	if (m_listenFd >= 0)
+	{
+		close(m_listenFd);
+		unlink(m_path.c_str());
+	}
+}
+
+bool LockstepLink::host(const string& path)
+{
+	sockaddr_un address;
+	if (m_fd >= 0 || !makeAddress(path, address))
+		return false;
+	signal(SIGPIPE, SIG_IGN);
+	unlink(path.c_str());
+	m_listenFd = socket(AF_UNIX, SOCK_STREAM, 0);
+	if (m_listenFd < 0 ||
+	    bind(m_listenFd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0 ||
+	    listen(m_listenFd, 1) != 0)
+	{
+		cerr << "Cannot listen at " << path << ": " << strerror(errno) << endl;
+		if (m_listenFd >= 0)
+			close(m_listenFd);
+		m_listenFd = -1;
+		return false;
+	}
+	m_path = path;
+	m_fd = accept(m_listenFd, NULL, NULL);
+	if (m_fd < 0)
+	{
+		cerr << "Cannot accept at " << path << ": " << strerror(errno) << endl;
+		return false;
+	}
+	m_broken = false;
+	return true;
+}
+
+bool LockstepLink::join(const string& path)
+{
+	sockaddr_un address;
+	if (m_fd >= 0 || !makeAddress(path, address))
+		return false;
+	signal(SIGPIPE, SIG_IGN);
+	long long giveUp = Telemetry::now() + JOIN_TIMEOUT_MS * 1000LL;
+	for (;;)
+	{
+		m_fd = socket(AF_UNIX, SOCK_STREAM, 0);
+		if (m_fd >= 0 && connect(m_fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) == 0)
+			break;
+		if (m_fd >= 0)
+			close(m_fd);
+		m_fd = -1;
+		if (Telemetry::now() > giveUp)
+		{
+			cerr << "Cannot connect to " << path << ": " << strerror(errno) << endl;
+			return false;
+		}
+		this_thread::sleep_for(chrono::milliseconds(50));
+	}
+	m_broken = false;
+	return true;
+}
+
+void LockstepLink::pump()
+{
+	long long now = Telemetry::now();
+	while (!m_broken && !m_outgoing.empty() && m_outgoing.front().due <= now)
+	{
+		const unsigned char* bytes = m_outgoing.front().bytes;
+		size_t sent = 0;
+		while (sent < MESSAGE_BYTES)
+		{
+			ssize_t n = ::send(m_fd, bytes + sent, MESSAGE_BYTES - sent, MSG_NOSIGNAL);
+			if (n < 0 && errno == EINTR)
+				continue;
+			if (n <= 0)
+			{
+				m_broken = true;
+				break;
+			}
+			sent += n;
+		}
+		m_outgoing.pop_front();
+	}
+}
+
+bool LockstepLink::receive(LockstepMessage& message, int timeoutMs)
+{
+	long long giveUp = Telemetry::now() + timeoutMs * 1000LL;
+	for (;;)
+	{
+		pump();
+		if (m_incoming.size() >= MESSAGE_BYTES)
+		{
+			const unsigned char* p = &m_incoming[0];
+			message.type = int(getWord(p));
+			message.tick = int(getWord(p + 4));
+			message.value = int(getWord(p + 8));
+			message.hash = getWord(p + 12);
+			m_incoming.erase(m_incoming.begin(), m_incoming.begin() + MESSAGE_BYTES);
+			return true;
+		}
+		if (m_broken)
+			return false;
+
+		  // Wake for whichever comes first: data, a held-back message
+		  // falling due, or the timeout
+		long long now = Telemetry::now();
+		long long wakeAt = giveUp;
+		if (!m_outgoing.empty() && m_outgoing.front().due < wakeAt)
+			wakeAt = m_outgoing.front().due;
+		pollfd fds = { m_fd, POLLIN, 0 };
+		if (poll(&fds, 1, wakeAt > now ? int((wakeAt - now + 999) / 1000) : 0) > 0)
+		{
+			unsigned char buffer[256];
+			ssize_t n = recv(m_fd, buffer, sizeof(buffer), 0);
+			if (n <= 0 && !(n < 0 && errno == EINTR))
+				m_broken = true;
+			else if (n > 0)
+				m_incoming.insert(m_incoming.end(), buffer, buffer + n);
+		}
+		else if (Telemetry::now() >= giveUp)
+			return false;
+	}
+}
+
+#endif // _WIN32
+
+void LockstepLink::setLatency(int latencyMs, int jitterMs, unsigned int seed)
+{
+	m_latency = latencyMs * 1000;
+	m_jitter = jitterMs * 1000;
+	m_jitterState = seed;
+}
+
+void LockstepLink::send(const LockstepMessage& message)
+{
+	Delayed d;
+	d.due = Telemetry::now() + m_latency;
+	if (m_jitter > 0)
+	{
+		m_jitterState = m_jitterState * 1103515245u + 12345u;
+		d.due += (long long)(m_jitterState >> 8) % (m_jitter + 1);
+	}
+	  // A stream delivers in order, so a message never overtakes the one
+	  // before it however the jitter falls
+	if (!m_outgoing.empty() && d.due < m_outgoing.back().due)
+		d.due = m_outgoing.back().due;
+	putWord(d.bytes, message.type);
+	putWord(d.bytes + 4, message.tick);
+	putWord(d.bytes + 8, message.value);
+	putWord(d.bytes + 12, message.hash);
+	m_outgoing.push_back(d);
+	pump();
+}
+
+void LockstepLink::drain()
+{
+	while (!m_broken && !m_outgoing.empty())
+	{
+		long long wait = m_outgoing.front().due - Telemetry::now();
+		if (wait > 0)
+			this_thread::sleep_for(chrono::microseconds(wait));
+		pump();
+	}
+}
+
+// LockstepSession
+
+LockstepSession::LockstepSession(LockstepLink& link, int localPlayer, int inputDelay, unsigned int seed)
+ : m_link(link), m_localPlayer(localPlayer), m_inputDelay(inputDelay > 0 ? inputDelay : 0), m_tick(0),
+   m_hashBase(0), m_hashesCompared(0), m_desyncTick(-1), m_stalledTicks(0), m_stallTime(0)
+{
+	GraphObject::setRegistryEnabled(false);
+	m_world = new StudentWorld;
+	m_world->seedRandom(seed);
+	m_world->setTwoPlayers(true);
+	m_world->init();
+	  // Nobody chose anything for the first ticks, so both sides idle
+	m_localInputs.assign(m_inputDelay, ACTION_NONE);
+	m_remoteInputs.assign(m_inputDelay, ACTION_NONE);
+	m_hashes.push_back(hashWorld());
+}
+
+LockstepSession::~LockstepSession()
+{
+	delete m_world;
+}
+
+int LockstepSession::tick(int localAction)
+{
+	if (m_desyncTick >= 0)
+		return -1;
+
+	LockstepMessage input = { LockstepMessage::INPUT, int(m_tick + 1 + m_inputDelay), localAction, getHash() };
+	m_localInputs.push_back(localAction);
+	m_link.send(input);
+
+	  // Take whatever the peer has sent already, then wait only if this
+	  // tick's input is not among it
+	LockstepMessage message;
+	while (m_link.receive(message, 0))
+	{
+		if (!takeInput(message))
+			return -1;
+	}
+	if (m_remoteInputs.empty())
+	{
+		m_stalledTicks++;
+		long long start = Telemetry::now();
+		while (m_remoteInputs.empty())
+		{
+			if (!m_link.receive(message, STALL_TIMEOUT_MS) || !takeInput(message))
+				return -1;
+		}
+		m_stallTime += Telemetry::now() - start;
+	}
+	  // The host's ship is player 0 on both sides
+	m_world->clearInjectedKeys();
+	AgentEnv::injectAction(m_world, m_localInputs.front(), m_localPlayer);
+	AgentEnv::injectAction(m_world, m_remoteInputs.front(), 1 - m_localPlayer);
+	m_localInputs.pop_front();
+	m_remoteInputs.pop_front();
+	int status = m_world->move();
+	if (status == GWSTATUS_PLAYER_DIED && !m_world->isGameOver())
+	{
+		m_world->cleanUp();
+		m_world->init();
+	}
+	m_tick++;
+
+	m_hashes.push_back(hashWorld());
+	if (m_hashes.size() > HASHES_KEPT)
+	{
+		m_hashes.pop_front();
+		m_hashBase++;
+	}
+	compareHashes();
+	return m_desyncTick >= 0 ? -1 : status;
+}
+
+// Queue the peer's input and keep its hash for when we reach that tick.
+// Inputs arrive in order, so each is for the first tick we have none for.
+bool LockstepSession::takeInput(const LockstepMessage& message)
+{
+	if (message.type != LockstepMessage::INPUT ||
+	    message.tick != m_tick + 1 + int(m_remoteInputs.size()))
+		return false;
+	m_remoteInputs.push_back(message.value);
+	if (message.tick - m_inputDelay - 1 >= 0)
+		m_peerHashes.push_back(make_pair((long long)(message.tick - m_inputDelay - 1), message.hash));
+	return true;
+}
+
+unsigned int LockstepSession::getHash() const
+{
+	return m_hashes.back();
+}
+
+bool LockstepSession::isGameOver() const
+{
+	return m_world->isGameOver();
+}
+
+// 32-bit FNV-1a of the world's snapshot, which holds everything a later
+// tick depends on, the random generator included
+unsigned int LockstepSession::hashWorld()
+{
+	if (m_snapshot.empty())
+		m_snapshot.resize(4096);
+	SnapshotWriter w(&m_snapshot[0], m_snapshot.size());
+	m_world->saveState(w);
+	if (!w.fits())
+	{
+		m_snapshot.resize(w.size() * 2);
+		w = SnapshotWriter(&m_snapshot[0], m_snapshot.size());
+		m_world->saveState(w);
+	}
+	unsigned int hash = 2166136261u;
+	for (size_t k = 0; k < w.size(); k++)
+		hash = (hash ^ (unsigned char)m_snapshot[k]) * 16777619u;
+	return hash;
+}
+
+// Check the peer's hashes for every tick we have reached
+void LockstepSession::compareHashes()
+{
+	while (!m_peerHashes.empty() && m_peerHashes.front().first <= m_tick)
+	{
+		long long t = m_peerHashes.front().first;
+		if (t >= m_hashBase)
+		{
+			m_hashesCompared++;
+			if (m_hashes[size_t(t - m_hashBase)] != m_peerHashes.front().second && m_desyncTick < 0)
+				m_desyncTick = t;
+		}
+		m_peerHashes.pop_front();
+	}
+}
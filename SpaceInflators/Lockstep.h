@@ -0,0 +1,154 @@
+#ifndef _LOCKSTEP_H_
+#define _LOCKSTEP_H_
+
+#include <string>
+#include <vector>
+#include <deque>
+#include <utility>
+
+class StudentWorld;
+
+// What lockstep peers send each other, as four little-endian 32-bit words
+struct LockstepMessage
+{
+	enum Type { HELLO = 1, INPUT = 2 };
+
+	int          type;
+	int          tick;     // HELLO: ticks to play; INPUT: the tick the action is for
+	int          value;    // HELLO: input delay;   INPUT: the action (AgentEnv's ACTION_ bits)
+	unsigned int hash;     // HELLO: world seed;    INPUT: state hash after tick - delay - 1
+};
+
+// A connection to the other lockstep process over a Unix domain socket.
+// For testing without a network, every message sent can be held back by a
+// fixed latency plus random jitter; messages still arrive in the order
+// they were sent.  Not available on Windows, where host() and join() fail.
+class LockstepLink
+{
+  public:
+	LockstepLink();
+	~LockstepLink();
+
+	bool host(const std::string& path);   // listen at path and wait for the peer
+	bool join(const std::string& path);   // connect, retrying while the host starts
+
+	  // Hold each message back latencyMs plus up to jitterMs, chosen by a
+	  // generator seeded with seed
+	void setLatency(int latencyMs, int jitterMs, unsigned int seed);
+
+	void send(const LockstepMessage& message);
+
+	  // Send whatever is due and wait up to timeoutMs for a message; false if
+	  // none came or the link has failed
+	bool receive(LockstepMessage& message, int timeoutMs);
+
+	  // Wait until every held-back message has been sent
+	void drain();
+
+	bool isBroken() const
+	{
+		return m_broken;
+	}
+
+  private:
+	LockstepLink(const LockstepLink&);
+	LockstepLink& operator=(const LockstepLink&);
+
+	enum { MESSAGE_BYTES = 16 };
+
+	struct Delayed
+	{
+		long long     due;   // Telemetry::now() when it may be sent
+		unsigned char bytes[MESSAGE_BYTES];
+	};
+
+	void pump();   // send the held-back messages that are due
+
+	int                        m_fd;
+	int                        m_listenFd;
+	std::string                m_path;
+	std::deque<Delayed>        m_outgoing;
+	std::vector<unsigned char> m_incoming;   // received, not yet a whole message
+	int                        m_latency;    // microseconds
+	int                        m_jitter;
+	unsigned int               m_jitterState;
+	bool                       m_broken;
+};
+
+// One side of a two-player lockstep game.  Both processes run the same
+// seeded two-player StudentWorld and exchange nothing but inputs: the
+// action chosen for this side on tick t is played on tick t + inputDelay,
+// which gives it that long to reach the peer before the peer needs it.
+// Every input also carries a hash of the sender's whole state a tick
+// earlier, so the first tick on which the two worlds differ is caught.
+class LockstepSession
+{
+  public:
+	  // localPlayer is 0 for the host's ship and 1 for the other
+	LockstepSession(LockstepLink& link, int localPlayer, int inputDelay, unsigned int seed);
+	~LockstepSession();
+
+	  // Send localAction for a later tick, wait for the peer's input for
+	  // this one and play it.  Returns the world's move() status, or -1 if
+	  // the link failed or the peers' states have diverged.
+	int tick(int localAction);
+
+	const StudentWorld& getWorld() const
+	{
+		return *m_world;
+	}
+
+	long long getTick() const
+	{
+		return m_tick;
+	}
+
+	unsigned int getHash() const;        // the state hash after the last tick
+	bool isGameOver() const;
+
+	long long getHashesCompared() const
+	{
+		return m_hashesCompared;
+	}
+
+	long long getDesyncTick() const      // first tick the hashes differed, or -1
+	{
+		return m_desyncTick;
+	}
+
+	long long getStalledTicks() const    // ticks that had to wait for the peer
+	{
+		return m_stalledTicks;
+	}
+
+	long long getStallTime() const       // microseconds spent waiting
+	{
+		return m_stallTime;
+	}
+
+  private:
+	LockstepSession(const LockstepSession&);
+	LockstepSession& operator=(const LockstepSession&);
+
+	bool takeInput(const LockstepMessage& message);   // false if it is out of order
+	unsigned int hashWorld();
+	void compareHashes();
+
+	LockstepLink&      m_link;
+	StudentWorld*      m_world;
+	int                m_localPlayer;
+	int                m_inputDelay;
+	long long          m_tick;             // ticks played
+	std::deque<int>    m_localInputs;      // for ticks m_tick + 1 on
+	std::deque<int>    m_remoteInputs;
+	long long          m_hashBase;         // the tick m_hashes[0] is for
+	std::deque<unsigned int> m_hashes;     // ours, for the last few ticks
+	std::deque<std::pair<long long, unsigned int> > m_peerHashes;   // theirs, (tick, hash), until we reach the tick
+	std::vector<char>  m_snapshot;         // scratch for hashing
+	long long          m_hashesCompared;
+	long long          m_desyncTick;
+	long long          m_stalledTicks;
+	long long          m_stallTime;
+};
+
+#endif // _LOCKSTEP_H_
@@ -0,0 +1,209 @@
+#include "Metrics.h"
+#include <fstream>
+#include <sstream>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <chrono>
+#if defined(_WIN32)
+#include <windows.h>
+#endif
+using namespace std;
+
+namespace
+{
+	const char* const IMAGE_NAMES[NUM_IMAGE_IDS] = {
+		"player", "nachling", "wealthy_nachling", "smallbot", "bullet", "torpedo",
+		"free_ship_goodie", "energy_goodie", "torpedo_goodie", "star"
+	};
+
+	void writeCounter(ostream& os, const char* name, const char* help, unsigned long long value)
+	{
+		os << "# HELP spaceinflators_" << name << " " << help << "\n"
+		   << "# TYPE spaceinflators_" << name << " counter\n"
+		   << "spaceinflators_" << name << " " << value << "\n";
+	}
+
+	  // rename() won't replace an existing file on Windows
+	bool replaceFile(const string& from, const string& to)
+	{
+#if defined(_WIN32)
+		return MoveFileExA(from.c_str(), to.c_str(), MOVEFILE_REPLACE_EXISTING) != 0;
+#else
+		return rename(from.c_str(), to.c_str()) == 0;
+#endif
+	}
+}
+
+// MetricsShard
+
+MetricsShard::MetricsShard()
+ : m_inUse(false)
+{
+	for (int k = 0; k < NUM_METRIC_COUNTERS; k++)
+		m_counters[k].store(0);
+	for (int k = 0; k < LatencyHistogram::NUM_BUCKETS; k++)
+		m_tickBuckets[k].store(0);
+	for (int k = 0; k < NUM_IMAGE_IDS; k++)
+		m_actors[k].store(0);
+}
+
+// MetricsRegistry
+
+MetricsRegistry::MetricsRegistry()
+ : m_running(false), m_stopping(false), m_intervalMs(1000)
+{
+}
+
+MetricsRegistry::~MetricsRegistry()
+{
+	stop();
+	for (size_t k = 0; k < m_shards.size(); k++)
+		delete m_shards[k];
+}
+
+void MetricsRegistry::start(const string& path, int intervalMs)
+{
+	if (m_running)
+		return;
+	m_path = path;
+	m_intervalMs = intervalMs > 0 ? intervalMs : 1000;
+	m_stopping = false;
+	m_running = true;
+	m_writer = thread(&MetricsRegistry::writerLoop, this);
+}
+
+void MetricsRegistry::stop()
+{
+	if (!m_running)
+		return;
+	{
+		lock_guard<mutex> lock(m_wakeMutex);
+		m_stopping = true;
+	}
+	m_wake.notify_one();
+	m_writer.join();
+	m_running = false;
+}
+
+MetricsShard* MetricsRegistry::acquireShard()
+{
+	if (!m_running)
+		return NULL;
+	lock_guard<mutex> lock(m_mutex);
+	for (size_t k = 0; k < m_shards.size(); k++)
+	{
+		if (!m_shards[k]->m_inUse)
+		{
+			m_shards[k]->m_inUse = true;
+			return m_shards[k];
+		}
+	}
+	MetricsShard* shard = new MetricsShard;
+	shard->m_inUse = true;
+	m_shards.push_back(shard);
+	return shard;
+}
+
+void MetricsRegistry::releaseShard(MetricsShard* shard)
+{
+	if (shard == NULL)
+		return;
+	lock_guard<mutex> lock(m_mutex);
+	for (int k = 0; k < NUM_IMAGE_IDS; k++)
+		shard->m_actors[k].store(0, memory_order_relaxed);
+	shard->m_inUse = false;
+}
+
+void MetricsRegistry::writeText(ostream& os)
+{
+	unsigned long long counters[NUM_METRIC_COUNTERS] = { 0 };
+	long long actors[NUM_IMAGE_IDS] = { 0 };
+	LatencyHistogram ticks;
+	{
+		lock_guard<mutex> lock(m_mutex);
+		for (size_t s = 0; s < m_shards.size(); s++)
+		{
+			const MetricsShard* shard = m_shards[s];
+			for (int k = 0; k < NUM_METRIC_COUNTERS; k++)
+				counters[k] += shard->m_counters[k].load(memory_order_relaxed);
+			for (int k = 0; k < NUM_IMAGE_IDS; k++)
+				actors[k] += shard->m_actors[k].load(memory_order_relaxed);
+			for (int k = 0; k < LatencyHistogram::NUM_BUCKETS; k++)
+				ticks.recordBucket(k, shard->m_tickBuckets[k].load(memory_order_relaxed));
+		}
+	}
+
+	writeCounter(os, "ticks_total", "Game ticks processed.", counters[METRIC_TICKS]);
+	os << "# HELP spaceinflators_tick_duration_seconds Time spent in move() per tick.\n"
+	   << "# TYPE spaceinflators_tick_duration_seconds summary\n";
+	static const double QUANTILES[] = { .5, .9, .99, .999 };
+	for (int k = 0; k < sizeof(QUANTILES)/sizeof(QUANTILES[0]); k++)
+		os << "spaceinflators_tick_duration_seconds{quantile=\"" << QUANTILES[k] << "\"} "
+		   << ticks.getPercentile(QUANTILES[k] * 100) / 1e6 << "\n";
+	os << "spaceinflators_tick_duration_seconds_sum " << counters[METRIC_TICK_MICROS] / 1e6 << "\n"
+	   << "spaceinflators_tick_duration_seconds_count " << counters[METRIC_TICKS] << "\n";
+
+	os << "# HELP spaceinflators_actors Actors alive at the end of the last tick, by type.\n"
+	   << "# TYPE spaceinflators_actors gauge\n";
+	for (int k = 0; k < NUM_IMAGE_IDS; k++)
+		os << "spaceinflators_actors{type=\"" << IMAGE_NAMES[k] << "\"} " << actors[k] << "\n";
+
+	writeCounter(os, "actors_allocated_total", "Actors constructed.", counters[METRIC_ACTORS_CREATED]);
+	writeCounter(os, "actors_freed_total", "Actors deleted.", counters[METRIC_ACTORS_DELETED]);
+	writeCounter(os, "collision_checks_total", "Actor pairs compared for collisions.",
+	             counters[METRIC_COLLISION_CHECKS]);
+	writeCounter(os, "sounds_total", "Sound effects triggered (dropped when headless).", counters[METRIC_SOUNDS]);
+	writeCounter(os, "frames_rendered_total", "Frames drawn.", counters[METRIC_FRAMES]);
+}
+
+bool MetricsRegistry::writeFile()
+{
+	ostringstream text;
+	writeText(text);
+	string tmp = m_path + ".tmp";
+	{
+		ofstream out(tmp.c_str(), ios::binary | ios::trunc);
+		out << text.str();
+		if (!out)
+			return false;
+	}
+	return replaceFile(tmp, m_path);
+}
+
+void MetricsRegistry::writerLoop()
+{
+	unique_lock<mutex> lock(m_wakeMutex);
+	for (;;)
+	{
+		if (!m_stopping)
+			m_wake.wait_for(lock, chrono::milliseconds(m_intervalMs));
+		bool stopping = m_stopping;
+		lock.unlock();
+		writeFile();   // one last time on the way out
+		lock.lock();
+		if (stopping)
+			break;
+	}
+}
+
+void metricsInit(int* argc, char* argv[])
+{
+	  // Every GameWorld asks the registry for a shard, possibly from several
+	  // threads at once, so create it here on the main thread first
+	Metrics();
+	if (*argc < 3 || strcmp(argv[1], "--metrics") != 0)
+		return;
+	int used = 2;
+	int intervalMs = 1000;
+	if (*argc > 3 && atof(argv[3]) > 0)
+	{
+		intervalMs = int(atof(argv[3]) * 1000);
+		used = 3;
+	}
+	Metrics().start(argv[2], intervalMs);
+	for (int k = 1; k + used < *argc; k++)
+		argv[k] = argv[k + used];
+	*argc -= used;
+	argv[*argc] = NULL;
+}
@@ -0,0 +1,121 @@
+#ifndef _METRICS_H_
+#define _METRICS_H_
+
+#include "GameConstants.h"
+#include "Telemetry.h"
+#include <atomic>
+#include <string>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+// Counters exported in Prometheus text format.  Each world owns one shard
+// and is only ever stepped by one thread, so updates are plain relaxed
+// loads and stores with no locked instructions.  A writer thread sums the
+// shards every interval and replaces the metrics file atomically (write a
+// temporary file, then rename it over the old one), so a scraper never
+// reads half a file.  Shards outlive their worlds: a released shard keeps
+// its counts and is handed to the next world, so counters never go down.
+
+enum MetricCounter
+{
+	METRIC_TICKS, METRIC_ACTORS_CREATED, METRIC_ACTORS_DELETED, METRIC_COLLISION_CHECKS,
+	METRIC_SOUNDS, METRIC_FRAMES, METRIC_TICK_MICROS,
+	NUM_METRIC_COUNTERS
+};
+
+class MetricsShard
+{
+  public:
+	MetricsShard();
+
+	void add(MetricCounter c, unsigned long long n = 1)
+	{
+		m_counters[c].store(m_counters[c].load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+	}
+
+	void recordTick(long long us)
+	{
+		add(METRIC_TICKS);
+		add(METRIC_TICK_MICROS, us);
+		std::atomic<unsigned long long>& b = m_tickBuckets[LatencyHistogram::bucketFor(us)];
+		b.store(b.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+	}
+
+	void setActors(int imageID, int count)
+	{
+		m_actors[imageID].store(count, std::memory_order_relaxed);
+	}
+
+  private:
+	friend class MetricsRegistry;
+
+	std::atomic<unsigned long long> m_counters[NUM_METRIC_COUNTERS];
+	std::atomic<unsigned long long> m_tickBuckets[LatencyHistogram::NUM_BUCKETS];
+	std::atomic<int>                m_actors[NUM_IMAGE_IDS];   // gauges; zeroed on release
+	bool                            m_inUse;                   // guarded by the registry's mutex
+};
+
+  // Null-safe helpers for call sites whose world may have no shard
+inline void metricsAdd(MetricsShard* shard, MetricCounter c, unsigned long long n = 1)
+{
+	if (shard != NULL)
+		shard->add(c, n);
+}
+
+class MetricsRegistry
+{
+  public:
+	  // Start writing path every intervalMs milliseconds
+	void start(const std::string& path, int intervalMs);
+	void stop();
+
+	bool isRunning() const
+	{
+		return m_running;
+	}
+
+	  // A shard for a new world, or NULL when metrics are off
+	MetricsShard* acquireShard();
+	void releaseShard(MetricsShard* shard);
+
+	void writeText(std::ostream& os);
+
+	  // Meyers singleton pattern
+	static MetricsRegistry& getInstance()
+	{
+		static MetricsRegistry instance;
+		return instance;
+	}
+
+  private:
+	MetricsRegistry();
+	~MetricsRegistry();
+	MetricsRegistry(const MetricsRegistry&);
+	MetricsRegistry& operator=(const MetricsRegistry&);
+
+	void writerLoop();
+	bool writeFile();
+
+	std::vector<MetricsShard*> m_shards;
+	std::mutex                 m_mutex;        // guards m_shards and shard ownership
+	std::mutex                 m_wakeMutex;
+	std::condition_variable    m_wake;
+	std::thread                m_writer;
+	bool                       m_running;
+	bool                       m_stopping;     // guarded by m_wakeMutex
+	std::string                m_path;
+	int                        m_intervalMs;
+};
+
+inline MetricsRegistry& Metrics()
+{
+	return MetricsRegistry::getInstance();
+}
+
+// Handles "--metrics FILE [SECONDS]" at the front of argv the way glutInit
+// handles its own options: starts the writer and removes them from argv.
+void metricsInit(int* argc, char* argv[]);
+
+#endif // _METRICS_H_
@@ -0,0 +1,214 @@
+#include "MonteCarlo.h"
+#include "AgentEnv.h"
+#include "AgentPolicy.h"
+#include "StudentWorld.h"
+#include "RoundParams.h"
+#include "Telemetry.h"
+#include <vector>
+#include <algorithm>
+#include <thread>
+#include <atomic>
+#include <iomanip>
+using namespace std;
+
+namespace
+{
+	const int MAX_ROUND = 30;                 // later rounds are pooled into this one
+	const int MAX_TICKS_PER_GAME = 1000000;   // a policy that can't die stops here
+
+	struct RoundTotals
+	{
+		long long   games;         // games that played any of this round
+		long long   ticks;
+		long long   deaths;
+		long long   kills;
+		vector<int> scoreGained;   // one entry per game that reached the round
+	};
+
+	struct Tally
+	{
+		Tally()
+		 : timedOut(0)
+		{
+			for (int r = 0; r <= MAX_ROUND; r++)
+				rounds[r].games = rounds[r].ticks = rounds[r].deaths = rounds[r].kills = 0;
+		}
+
+		RoundTotals rounds[MAX_ROUND+1];   // indexed by round; 0 is unused
+		vector<int> finalScores;
+		vector<int> gameTicks;
+		long long   timedOut;
+	};
+
+	struct Worker
+	{
+		AgentEnv         env;
+		AgentPolicy*     policy;
+		AgentObservation obs;
+		Tally            tally;
+	};
+
+	void playGame(Worker& w, unsigned int seed)
+	{
+		int ticks[MAX_ROUND+1], deaths[MAX_ROUND+1], kills[MAX_ROUND+1], score[MAX_ROUND+1];
+		for (int r = 0; r <= MAX_ROUND; r++)
+			ticks[r] = deaths[r] = kills[r] = score[r] = 0;
+
+		w.env.reset(seed, w.obs);
+		w.policy->reset(seed);
+		int totalTicks = 0;
+		while (!w.env.isDone() && totalTicks < MAX_TICKS_PER_GAME)
+		{
+			int round = min(w.obs.round, MAX_ROUND);
+			int killsBefore = w.env.getWorld()->getTotalKills();
+			AgentStepResult result = w.env.step(w.policy->chooseAction(w.obs), w.obs);
+			ticks[round]++;
+			totalTicks++;
+			score[round] += result.reward;
+			kills[round] += w.env.getWorld()->getTotalKills() - killsBefore;
+			if (result.lifeLost)
+				deaths[round]++;
+		}
+
+		if (!w.env.isDone())
+			w.tally.timedOut++;
+		for (int r = 1; r <= MAX_ROUND; r++)
+		{
+			if (ticks[r] == 0)
+				continue;
+			RoundTotals& t = w.tally.rounds[r];
+			t.games++;
+			t.ticks += ticks[r];
+			t.deaths += deaths[r];
+			t.kills += kills[r];
+			t.scoreGained.push_back(score[r]);
+		}
+		w.tally.finalScores.push_back(w.obs.score);
+		w.tally.gameTicks.push_back(totalTicks);
+	}
+
+	void workerLoop(Worker* w, atomic<long long>* nextGame, long long games, unsigned int seed)
+	{
+		for (;;)
+		{
+			long long g = nextGame->fetch_add(1);
+			if (g >= games)
+				break;
+			playGame(*w, seed + (unsigned int)g);
+		}
+	}
+
+	void append(vector<int>& to, const vector<int>& from)
+	{
+		to.insert(to.end(), from.begin(), from.end());
+	}
+
+	  // pct in [0, 100] of a sorted, non-empty vector
+	int percentile(const vector<int>& sorted, double pct)
+	{
+		size_t index = size_t(pct / 100 * (sorted.size() - 1) + .5);
+		return sorted[index];
+	}
+
+	double mean(const vector<int>& values)
+	{
+		double total = 0;
+		for (size_t k = 0; k < values.size(); k++)
+			total += values[k];
+		return values.empty() ? 0 : total / values.size();
+	}
+
+	void writeDistribution(ostream& os, const char* name, vector<int>& values)
+	{
+		if (values.empty())
+			return;
+		sort(values.begin(), values.end());
+		os << name << ": mean " << mean(values) << " (p10 " << percentile(values, 10)
+		   << ", p50 " << percentile(values, 50) << ", p90 " << percentile(values, 90) << ")" << endl;
+	}
+}
+
+int runMonteCarlo(const string& policyName, long long games, unsigned int seed, int threads, ostream& os)
+{
+	if (threads <= 0)
+		threads = max(1, int(thread::hardware_concurrency()));
+
+	  // Build every worker (and so every AgentEnv) before any thread starts
+	vector<Worker*> workers;
+	for (int k = 0; k < threads; k++)
+	{
+		Worker* w = new Worker;
+		w->policy = createAgentPolicy(policyName);
+		workers.push_back(w);
+		if (w->policy == NULL)
+		{
+			os << "Unknown policy \"" << policyName << "\"; choose from " << agentPolicyNames() << endl;
+			for (size_t i = 0; i < workers.size(); i++)
+				delete workers[i];
+			return 1;
+		}
+	}
+
+	  // The round table is built on first use; build it on this thread, since
+	  // compilers without thread-safe statics would race the workers to it
+	roundParams(1);
+
+	long long start = Telemetry::now();
+	atomic<long long> nextGame(0);
+	vector<thread> pool;
+	for (int k = 0; k < threads; k++)
+		pool.push_back(thread(workerLoop, workers[k], &nextGame, games, seed));
+	for (int k = 0; k < threads; k++)
+		pool[k].join();
+	long long elapsed = Telemetry::now() - start;
+
+	  // Everything is combined as sums or sorted lists, so the result does
+	  // not depend on which thread played which game
+	Tally total;
+	for (int k = 0; k < threads; k++)
+	{
+		const Tally& t = workers[k]->tally;
+		for (int r = 1; r <= MAX_ROUND; r++)
+		{
+			total.rounds[r].games += t.rounds[r].games;
+			total.rounds[r].ticks += t.rounds[r].ticks;
+			total.rounds[r].deaths += t.rounds[r].deaths;
+			total.rounds[r].kills += t.rounds[r].kills;
+			append(total.rounds[r].scoreGained, t.rounds[r].scoreGained);
+		}
+		append(total.finalScores, t.finalScores);
+		append(total.gameTicks, t.gameTicks);
+		total.timedOut += t.timedOut;
+		delete workers[k]->policy;
+		delete workers[k];
+	}
+
+	os << "Policy " << policyName << ": " << games << " games from seed " << seed << " on " << threads
+	   << " threads in " << elapsed / 1000000.0 << " s";
+	if (total.timedOut > 0)
+		os << " (" << total.timedOut << " stopped at " << MAX_TICKS_PER_GAME << " ticks)";
+	os << endl;
+	writeDistribution(os, "Game length (ticks)", total.gameTicks);
+	writeDistribution(os, "Final score", total.finalScores);
+
+	os << endl << "Round   Games  Ticks/life  Kills/100 ticks   Score gained p10 / p50 / p90" << endl;
+	os << fixed << setprecision(1);
+	for (int r = 1; r <= MAX_ROUND; r++)
+	{
+		RoundTotals& t = total.rounds[r];
+		if (t.games == 0)
+			continue;
+		sort(t.scoreGained.begin(), t.scoreGained.end());
+		os << setw(3) << r << (r == MAX_ROUND ? "+" : " ") << setw(9) << t.games;
+		if (t.deaths > 0)
+			os << setw(12) << double(t.ticks) / t.deaths;
+		else
+			os << setw(12) << "-";
+		os << setw(17) << 100.0 * t.kills / t.ticks
+		   << "   " << setw(8) << percentile(t.scoreGained, 10) << " / " << percentile(t.scoreGained, 50)
+		   << " / " << percentile(t.scoreGained, 90) << endl;
+	}
+	os.unsetf(ios::floatfield);
+	os << setprecision(6);
+	return 0;
+}
@@ -0,0 +1,18 @@
+#ifndef _MONTECARLO_H_
+#define _MONTECARLO_H_
+
+#include <iostream>
+#include <string>
+
+// Play games seeded seed, seed+1, ..., seed+games-1 with the named
+// AgentPolicy on the given number of threads (0 means one per core) and
+// write per-round difficulty statistics to os: how many games reach each
+// round, how long a life lasts in it, how fast aliens die and how much
+// score it yields.  Each game depends only on its seed, and totals are
+// combined in an order that doesn't depend on scheduling, so a run is
+// reproducible whatever the thread count.  Returns 0, or 1 if the policy
+// name is unknown.
+int runMonteCarlo(const std::string& policyName, long long games, unsigned int seed, int threads,
+                  std::ostream& os);
+
+#endif // _MONTECARLO_H_
@@ -0,0 +1,77 @@
+#include "OfflineAudio.h"
+#include "GraphObject.h"
+#include <fstream>
+#include <iostream>
+#include <vector>
+using namespace std;
+
+OfflineAudioRenderer::OfflineAudioRenderer()
+ : m_sink(NULL), m_ticks(0), m_events(0), m_framesWritten(0), m_checksum(14695981039346656037ULL)
+{
+	for (int k = 0; k < NUM_SOUNDS; k++)
+		m_clipFor[k] = NULL;
+}
+
+OfflineAudioRenderer::~OfflineAudioRenderer()
+{
+	delete m_sink;   // fills in the WAV header's sizes
+}
+
+bool OfflineAudioRenderer::open(const string& path)
+{
+	for (int k = 0; k < NUM_SOUNDS; k++)
+	{
+		map<string, SoundClip>::iterator p = m_clips.find(SOUND_FILES[k]);
+		if (p == m_clips.end())
+		{
+			ifstream in(SOUND_FILES[k], ios::binary);
+			vector<char> data((istreambuf_iterator<char>(in)), istreambuf_iterator<char>());
+			SoundClip clip;
+			if (data.empty() || !decodeWav(&data[0], data.size(), clip))
+			{
+				cerr << "Cannot decode " << SOUND_FILES[k] << endl;
+				return false;
+			}
+			p = m_clips.insert(make_pair(string(SOUND_FILES[k]), clip)).first;
+		}
+		m_clipFor[k] = &p->second;
+	}
+
+	delete m_sink;
+	m_sink = new FileAudioSink(path);
+	if (!m_sink->isOpen())
+	{
+		cerr << "Cannot write " << path << endl;
+		return false;
+	}
+	return true;
+}
+
+void OfflineAudioRenderer::soundPlayed(int soundID)
+{
+	if (soundID < 0 || soundID >= NUM_SOUNDS || m_clipFor[soundID] == NULL)
+		return;
+	m_mixer.play(m_clipFor[soundID]);
+	m_events++;
+}
+
+void OfflineAudioRenderer::endTick()
+{
+	m_ticks++;
+	  // Round tick boundaries to whole frames without drifting
+	long long tickEnd = m_ticks * MIXER_RATE * MS_PER_TICK / 1000;
+	while (m_framesWritten < tickEnd)
+	{
+		int frames = int(tickEnd - m_framesWritten < MIXER_BLOCK ? tickEnd - m_framesWritten : MIXER_BLOCK);
+		m_mixer.mix(m_block, frames);
+		for (int i = 0; i < frames * MIXER_CHANNELS; i++)
+		{
+			unsigned short sample = (unsigned short)(m_block[i]);
+			m_checksum = (m_checksum ^ (sample & 0xff)) * 1099511628211ULL;
+			m_checksum = (m_checksum ^ (sample >> 8)) * 1099511628211ULL;
+		}
+		if (m_sink != NULL)
+			m_sink->write(m_block, frames);
+		m_framesWritten += frames;
+	}
+}
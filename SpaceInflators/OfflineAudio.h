@@ -0,0 +1,59 @@
+#ifndef _OFFLINEAUDIO_H_
+#define _OFFLINEAUDIO_H_
+
+#include "GameConstants.h"
+#include "SoundMixer.h"
+#include "AudioSink.h"
+#include <string>
+#include <map>
+
+// Renders a headless session's sounds into a WAV file as fast as the CPU
+// allows.  Each tick is MS_PER_TICK of audio, as in the windowed game, and
+// every sound played during a tick starts at that tick's first sample.
+// Nothing depends on the clock, so the same seed and inputs always give
+// the same file, bit for bit; getChecksum() makes that easy to compare.
+class OfflineAudioRenderer
+{
+  public:
+	OfflineAudioRenderer();
+	~OfflineAudioRenderer();
+
+	  // Decode the clips (from the current directory) and start the file;
+	  // false with a message on cerr if any of that fails
+	bool open(const std::string& path);
+
+	void soundPlayed(int soundID);   // queue a sound at the current tick
+	void endTick();                  // mix the tick into the file
+
+	long long getTicks() const
+	{
+		return m_ticks;
+	}
+
+	long long getEvents() const
+	{
+		return m_events;
+	}
+
+	  // 64-bit FNV-1a of every sample written so far
+	unsigned long long getChecksum() const
+	{
+		return m_checksum;
+	}
+
+  private:
+	OfflineAudioRenderer(const OfflineAudioRenderer&);
+	OfflineAudioRenderer& operator=(const OfflineAudioRenderer&);
+
+	std::map<std::string, SoundClip> m_clips;   // decoded once per file
+	const SoundClip*   m_clipFor[NUM_SOUNDS];
+	SoundMixer         m_mixer;
+	FileAudioSink*     m_sink;
+	long long          m_ticks;
+	long long          m_events;
+	long long          m_framesWritten;
+	unsigned long long m_checksum;
+	short              m_block[MIXER_BLOCK * MIXER_CHANNELS];
+};
+
+#endif // _OFFLINEAUDIO_H_
@@ -0,0 +1,25 @@
+#include "RoundParams.h"
+
+const RoundParams* buildRoundTable()
+{
+	static RoundParams table[ROUND_TABLE_SIZE];
+	for (int round = 1; round <= ROUND_TABLE_SIZE; round++)
+		table[round - 1] = computeRoundParams(round);
+	return table;
+}
+
+  // Energies were int(base*(0.9+0.1*round)) and the spawn cap
+  // int(2+.5*round); these integer forms give the same values
+RoundParams computeRoundParams(int round)
+{
+	RoundParams p;
+	p.nachlingEnergy = 5 * (9 + round) / 10;
+	p.wealthyNachlingEnergy = 8 * (9 + round) / 10;
+	p.smallbotEnergy = 12 * (9 + round) / 10;
+	p.goodieLifetime = 100 / round + 30;
+	p.nachlingFireChance = 10 / round + 1;
+	p.smallbotTorpedoChance = 100 / round + 1;
+	p.alienProjectileQuota = 2 * round;
+	p.maxAliensOnScreen = 2 + round / 2;
+	return p;
+}
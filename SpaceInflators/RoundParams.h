@@ -0,0 +1,38 @@
+#ifndef _ROUNDPARAMS_H_
+#define _ROUNDPARAMS_H_
+
+// Everything that depends on the round number.  The values for the first
+// ROUND_TABLE_SIZE rounds are computed once into a table, so a lookup is a
+// single load; later rounds fall back to computing them.  All of it is
+// integer arithmetic (the same values the old floating-point formulas
+// gave), so every compiler and platform agrees on them.
+struct RoundParams
+{
+	int nachlingEnergy;          // starting energy of each alien
+	int wealthyNachlingEnergy;
+	int smallbotEnergy;
+	int goodieLifetime;          // ticks a goodie stays on screen
+	int nachlingFireChance;      // a Nachling fires with probability 1 in this
+	int smallbotTorpedoChance;   // a Smallbot fires a torpedo with probability 1 in this
+	int alienProjectileQuota;    // most alien projectiles allowed on screen
+	int maxAliensOnScreen;       // no more aliens are added past this many
+};
+
+const int ROUND_TABLE_SIZE = 32;
+
+RoundParams computeRoundParams(int round);     // round >= 1
+const RoundParams* buildRoundTable();          // rounds 1 to ROUND_TABLE_SIZE; call once
+
+  // Inlined, a field of the result is one load for tabled rounds.  The
+  // table is built on first use rather than by a namespace-scope
+  // initializer, so a lookup from another file's static initializer
+  // can't see it before it exists.
+inline RoundParams roundParams(int round)
+{
+	static const RoundParams* const table = buildRoundTable();
+	if (round >= 1 && round <= ROUND_TABLE_SIZE)
+		return table[round - 1];
+	return computeRoundParams(round);
+}
+
+#endif // _ROUNDPARAMS_H_
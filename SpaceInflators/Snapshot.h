@@ -0,0 +1,149 @@
+#ifndef _SNAPSHOT_H_
+#define _SNAPSHOT_H_
+
+#include <cstddef>
+#include <cstring>
+
+// Flat binary encoding of world state for save/restore.  Values are stored
+// in native byte order, so a snapshot is only good on the architecture that
+// made it.
+//
+// A SnapshotWriter writes into a caller-owned buffer and keeps counting
+// once the buffer is full, so a first pass with no buffer gives the size
+// to allocate.  A SnapshotReader returns zeros once it runs past the end
+// of its buffer and remembers that it did; check ok() when done.
+
+const int SNAPSHOT_MAGIC   = 0x314e4953;   // "SIN1"
+const int SNAPSHOT_VERSION = 3;
+
+class SnapshotWriter
+{
+  public:
+	SnapshotWriter(void* buffer, size_t capacity)
+	 : m_buffer(static_cast<char*>(buffer)), m_capacity(buffer != NULL ? capacity : 0), m_size(0)
+	{
+	}
+
+	void putInt(int value)
+	{
+		put(&value, sizeof(value));
+	}
+
+	void putUnsigned(unsigned int value)
+	{
+		put(&value, sizeof(value));
+	}
+
+	void putDouble(double value)
+	{
+		put(&value, sizeof(value));
+	}
+
+	void putBool(bool value)
+	{
+		putInt(value ? 1 : 0);
+	}
+
+	size_t size() const
+	{
+		return m_size;
+	}
+
+	bool fits() const
+	{
+		return m_size <= m_capacity;
+	}
+
+  private:
+	void put(const void* value, size_t n)
+	{
+		if (m_size + n <= m_capacity)
+			memcpy(m_buffer + m_size, value, n);
+		m_size += n;
+	}
+
+	char*  m_buffer;
+	size_t m_capacity;
+	size_t m_size;
+};
+
+class SnapshotReader
+{
+  public:
+	SnapshotReader(const void* buffer, size_t size)
+	 : m_buffer(static_cast<const char*>(buffer)), m_size(buffer != NULL ? size : 0), m_pos(0), m_ok(true)
+	{
+	}
+
+	int getInt()
+	{
+		int value = 0;
+		get(&value, sizeof(value));
+		return value;
+	}
+
+	unsigned int getUnsigned()
+	{
+		unsigned int value = 0;
+		get(&value, sizeof(value));
+		return value;
+	}
+
+	double getDouble()
+	{
+		double value = 0;
+		get(&value, sizeof(value));
+		return value;
+	}
+
+	bool getBool()
+	{
+		return getInt() != 0;
+	}
+
+	  // Read a count that must lie in [0, max]; a bad one fails the read
+	int getCount(int max)
+	{
+		int n = getInt();
+		if (n < 0 || n > max)
+		{
+			m_ok = false;
+			return 0;
+		}
+		return n;
+	}
+
+	void fail()
+	{
+		m_ok = false;
+	}
+
+	bool ok() const
+	{
+		return m_ok;
+	}
+
+	bool atEnd() const
+	{
+		return m_pos == m_size;
+	}
+
+  private:
+	void get(void* value, size_t n)
+	{
+		if (!m_ok || m_pos + n > m_size)
+		{
+			m_ok = false;
+			return;
+		}
+		memcpy(value, m_buffer + m_pos, n);
+		m_pos += n;
+	}
+
+	const char* m_buffer;
+	size_t      m_size;
+	size_t      m_pos;
+	bool        m_ok;
+};
+
+#endif // _SNAPSHOT_H_
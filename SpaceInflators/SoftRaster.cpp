@@ -0,0 +1,681 @@
+#include "SoftRaster.h"
+#include "GraphObject.h"
+#include "GameConstants.h"
+#include "StarField.h"
+#include "EffectPool.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define SOFTRASTER_SSE2
+#include <emmintrin.h>
+#endif
+
+using namespace std;
+
+static const int TILE_ROWS = 32;            // height of one horizontal tile band
+static const int MAX_SPAN_CROSSINGS = 256;  // edge crossings kept per scanline
+
+static const double PI = 4 * atan(1.0);
+
+// Stroke font: each glyph is a set of strokes separated by spaces, each
+// stroke a run of "xy" digit pairs on a 5x7 grid (x 0..4, y 0..6, y up).
+
+struct StrokeGlyph
+{
+	char        ch;
+	const char* strokes;
+};
+
+static const StrokeGlyph STROKE_GLYPHS[] = {
+	{ '0', "0040460600" },           { '1', "152620 1030" },
+	{ '2', "064643030040" },         { '3', "06464000 0343" },
+	{ '4', "060343 4640" },          { '5', "460603434000" },
+	{ '6', "460600404303" },         { '7', "064640" },
+	{ '8', "0040460600 0343" },      { '9', "430306464000" },
+	{ 'A', "00064640 0343" },        { 'B', "00063645443303 3342413000" },
+	{ 'C', "46060040" },             { 'D', "00063645413000" },
+	{ 'E', "46060040 0333" },        { 'F', "460600 0333" },
+	{ 'G', "460600404323" },         { 'H', "0006 4640 0343" },
+	{ 'I', "0646 2620 0040" },       { 'J', "46400001" },
+	{ 'K', "0006 460340" },          { 'L', "060040" },
+	{ 'M', "0006234640" },           { 'N', "00064046" },
+	{ 'O', "0040460600" },           { 'P', "0006464303" },
+	{ 'Q', "0040460600 2240" },      { 'R', "0006464303 2340" },
+	{ 'S', "460603434000" },         { 'T', "0646 2620" },
+	{ 'U', "06004046" },             { 'V', "062046" },
+	{ 'W', "0600234046" },           { 'X', "0046 0640" },
+	{ 'Y', "062346 2320" },          { 'Z', "06460040" },
+	{ ':', "2122 2425" },            { '.', "2021" },
+	{ '!', "2622 2021" },            { '-', "0343" },
+	{ '%', "0046 0516 3041" },       { '?', "050646432322 2120" },
+};
+
+static const char* findGlyph(char ch)
+{
+	if (ch >= 'a' && ch <= 'z')
+		ch = ch - 'a' + 'A';
+	for (size_t k = 0; k < sizeof(STROKE_GLYPHS)/sizeof(STROKE_GLYPHS[0]); k++)
+		if (STROKE_GLYPHS[k].ch == ch)
+			return STROKE_GLYPHS[k].strokes;
+	return NULL;   // blank (space or unsupported character)
+}
+
+static const double GLYPH_GRID_HEIGHT  = 6;
+static const double GLYPH_GRID_ADVANCE = 6;
+
+static unsigned int packColor(double r, double g, double b)
+{
+	double rgb[3] = { r, g, b };
+	unsigned int c = 0xff000000u;
+	for (int k = 0; k < 3; k++)
+	{
+		double v = rgb[k] < 0 ? 0 : (rgb[k] > 1 ? 1 : rgb[k]);
+		c |= (unsigned int)(v * 255 + 0.5) << (8*k);
+	}
+	return c;
+}
+
+static void fillSpan(unsigned int* row, int x0, int x1, unsigned int color)
+{
+	int x = x0;
+#ifdef SOFTRASTER_SSE2
+	const __m128i c = _mm_set1_epi32(int(color));
+	for ( ; x < x1 && (reinterpret_cast<size_t>(row + x) & 15) != 0; x++)
+		row[x] = color;
+	for ( ; x + 8 <= x1; x += 8)
+	{
+		_mm_store_si128(reinterpret_cast<__m128i*>(row + x), c);
+		_mm_store_si128(reinterpret_cast<__m128i*>(row + x + 4), c);
+	}
+	for ( ; x + 4 <= x1; x += 4)
+		_mm_store_si128(reinterpret_cast<__m128i*>(row + x), c);
+#endif
+	for ( ; x < x1; x++)
+		row[x] = color;
+}
+
+// SoftFramebuffer
+
+SoftFramebuffer::SoftFramebuffer(int width, int height)
+ : m_width(0), m_height(0)
+{
+	resize(width, height);
+}
+
+void SoftFramebuffer::resize(int width, int height)
+{
+	m_width = width > 0 ? width : 0;
+	m_height = height > 0 ? height : 0;
+	m_pixels.assign(size_t(m_width) * m_height, 0);
+}
+
+void SoftFramebuffer::clear(unsigned int rgba)
+{
+	for (int y = 0; y < m_height; y++)
+		fillSpan(getRow(y), 0, m_width, rgba);
+}
+
+// SoftRasterizer
+
+SoftRasterizer::SoftRasterizer()
+ : m_color(0xffffffffu), m_lineWidth(1), m_lastCommands(0), m_lastPixels(0),
+   m_target(NULL), m_generation(0), m_pending(0), m_shutdown(false)
+{
+	m_workerPixels.assign(1, 0);
+}
+
+SoftRasterizer::~SoftRasterizer()
+{
+	setThreadCount(1);
+}
+
+void SoftRasterizer::setThreadCount(int n)
+{
+	if (n < 1)
+		n = 1;
+	if (!m_workers.empty())
+	{
+		{
+			lock_guard<mutex> lock(m_mutex);
+			m_shutdown = true;
+		}
+		m_wake.notify_all();
+		for (size_t k = 0; k < m_workers.size(); k++)
+			m_workers[k].join();
+		m_workers.clear();
+		m_shutdown = false;
+	}
+	m_workerPixels.assign(n, 0);
+	for (int k = 1; k < n; k++)
+		m_workers.push_back(thread(&SoftRasterizer::workerLoop, this, k, m_generation));
+}
+
+void SoftRasterizer::setColor(double r, double g, double b)
+{
+	m_color = packColor(r, g, b);
+}
+
+void SoftRasterizer::setLineWidth(double w)
+{
+	m_lineWidth = w;
+}
+
+void SoftRasterizer::clear(unsigned int rgba)
+{
+	Command cmd;
+	cmd.type = CLEAR;
+	cmd.color = rgba;
+	cmd.lineWidth = 0;
+	cmd.firstVertex = 0;
+	cmd.nVertices = 0;
+	m_commands.push_back(cmd);
+}
+
+void SoftRasterizer::addCommand(CommandType type, const RasterPoint points[], int nPoints)
+{
+	if (nPoints < 2)
+		return;
+	Command cmd;
+	cmd.type = type;
+	cmd.color = m_color;
+	cmd.lineWidth = m_lineWidth;
+	cmd.firstVertex = int(m_vertices.size());
+	cmd.nVertices = nPoints;
+	m_vertices.insert(m_vertices.end(), points, points + nPoints);
+	m_commands.push_back(cmd);
+}
+
+void SoftRasterizer::fillPolygon(const RasterPoint points[], int nPoints)
+{
+	if (nPoints >= 3)
+		addCommand(FILL_POLYGON, points, nPoints);
+}
+
+void SoftRasterizer::drawLineStrip(const RasterPoint points[], int nPoints)
+{
+	addCommand(LINE_STRIP, points, nPoints);
+}
+
+void SoftRasterizer::drawLineLoop(const RasterPoint points[], int nPoints)
+{
+	addCommand(LINE_LOOP, points, nPoints);
+}
+
+void SoftRasterizer::drawStrokeText(double x, double y, double height, const char* str)
+{
+	double scale = height / GLYPH_GRID_HEIGHT;
+	for ( ; *str != '\0'; str++, x += GLYPH_GRID_ADVANCE * scale)
+	{
+		const char* s = findGlyph(*str);
+		if (s == NULL)
+			continue;
+		RasterPoint stroke[16];
+		int n = 0;
+		for ( ; ; s += 2)
+		{
+			if (*s == ' ' || *s == '\0')
+			{
+				drawLineStrip(stroke, n);
+				n = 0;
+				if (*s == '\0')
+					break;
+				s--;   // a space is a single character, not a pair
+				continue;
+			}
+			stroke[n].x = x + (s[0] - '0') * scale;
+			stroke[n].y = y - (s[1] - '0') * scale;
+			if (n < 15)
+				n++;
+		}
+	}
+}
+
+double SoftRasterizer::strokeTextWidth(double height, const char* str) const
+{
+	size_t len = strlen(str);
+	if (len == 0)
+		return 0;
+	return (len * GLYPH_GRID_ADVANCE - (GLYPH_GRID_ADVANCE - 4)) * height / GLYPH_GRID_HEIGHT;
+}
+
+void SoftRasterizer::flush(SoftFramebuffer& fb)
+{
+	m_lastCommands = (unsigned int)m_commands.size();
+	if (m_workers.empty())
+		m_lastPixels = rasterizeBand(fb, 0, fb.getHeight());
+	else
+	{
+		{
+			lock_guard<mutex> lock(m_mutex);
+			m_target = &fb;
+			m_pending = int(m_workers.size());
+			m_generation++;
+		}
+		m_wake.notify_all();
+
+		int nWorkers = int(m_workerPixels.size());
+		unsigned long long pixels = 0;
+		for (int y = 0; y < fb.getHeight(); y += nWorkers * TILE_ROWS)
+			pixels += rasterizeBand(fb, y, min(y + TILE_ROWS, fb.getHeight()));
+
+		unique_lock<mutex> lock(m_mutex);
+		while (m_pending > 0)
+			m_done.wait(lock);
+		for (int k = 1; k < nWorkers; k++)
+			pixels += m_workerPixels[k];
+		m_lastPixels = pixels;
+		m_target = NULL;
+	}
+	m_commands.clear();
+	m_vertices.clear();
+}
+
+void SoftRasterizer::workerLoop(int index, unsigned int generation)
+{
+	unsigned int seen = generation;
+	for (;;)
+	{
+		SoftFramebuffer* fb;
+		{
+			unique_lock<mutex> lock(m_mutex);
+			while (!m_shutdown && m_generation == seen)
+				m_wake.wait(lock);
+			if (m_shutdown)
+				return;
+			seen = m_generation;
+			fb = m_target;
+		}
+
+		int nWorkers = int(m_workerPixels.size());
+		unsigned long long pixels = 0;
+		for (int y = index * TILE_ROWS; y < fb->getHeight(); y += nWorkers * TILE_ROWS)
+			pixels += rasterizeBand(*fb, y, min(y + TILE_ROWS, fb->getHeight()));
+		m_workerPixels[index] = pixels;
+
+		{
+			lock_guard<mutex> lock(m_mutex);
+			m_pending--;
+		}
+		m_done.notify_one();
+	}
+}
+
+unsigned long long SoftRasterizer::rasterizeBand(SoftFramebuffer& fb, int y0, int y1)
+{
+	unsigned long long pixels = 0;
+	for (size_t k = 0; k < m_commands.size(); k++)
+	{
+		const Command& cmd = m_commands[k];
+		if (cmd.type == CLEAR)
+		{
+			for (int y = y0; y < y1; y++)
+				fillSpan(fb.getRow(y), 0, fb.getWidth(), cmd.color);
+			pixels += (unsigned long long)(y1 - y0) * fb.getWidth();
+			continue;
+		}
+		const RasterPoint* pts = &m_vertices[cmd.firstVertex];
+		if (cmd.type == FILL_POLYGON)
+			pixels += fillPolygonBand(fb, pts, cmd.nVertices, cmd.color, y0, y1);
+		else
+		{
+			for (int i = 0; i + 1 < cmd.nVertices; i++)
+				pixels += drawSegmentBand(fb, pts[i], pts[i+1], cmd.lineWidth, cmd.color, y0, y1);
+			if (cmd.type == LINE_LOOP)
+				pixels += drawSegmentBand(fb, pts[cmd.nVertices-1], pts[0], cmd.lineWidth, cmd.color, y0, y1);
+		}
+	}
+	return pixels;
+}
+
+// Even-odd scanline fill sampled at pixel centres, clipped to rows [y0, y1)
+unsigned long long SoftRasterizer::fillPolygonBand(SoftFramebuffer& fb, const RasterPoint* pts, int n,
+                                                   unsigned int color, int y0, int y1)
+{
+	double minY = pts[0].y, maxY = pts[0].y;
+	for (int i = 1; i < n; i++)
+	{
+		minY = min(minY, pts[i].y);
+		maxY = max(maxY, pts[i].y);
+	}
+	int rowStart = max(y0, int(ceil(minY - 0.5)));
+	int rowEnd = min(y1, int(ceil(maxY - 0.5)));
+
+	unsigned long long pixels = 0;
+	double crossings[MAX_SPAN_CROSSINGS];
+	for (int row = rowStart; row < rowEnd; row++)
+	{
+		double yc = row + 0.5;
+		int nCross = 0;
+		for (int i = 0, j = n-1; i < n; j = i++)
+		{
+			const RasterPoint& a = pts[j];
+			const RasterPoint& b = pts[i];
+			if ((a.y <= yc && yc < b.y) || (b.y <= yc && yc < a.y))
+			{
+				if (nCross < MAX_SPAN_CROSSINGS)
+					crossings[nCross++] = a.x + (yc - a.y) * (b.x - a.x) / (b.y - a.y);
+			}
+		}
+		sort(crossings, crossings + nCross);
+		unsigned int* line = fb.getRow(row);
+		for (int k = 0; k + 1 < nCross; k += 2)
+		{
+			int xs = max(0, int(ceil(crossings[k] - 0.5)));
+			int xe = min(fb.getWidth(), int(ceil(crossings[k+1] - 0.5)));
+			if (xs < xe)
+			{
+				fillSpan(line, xs, xe, color);
+				pixels += xe - xs;
+			}
+		}
+	}
+	return pixels;
+}
+
+// Thin segments are stepped pixel by pixel; wide ones become a filled quad.
+unsigned long long SoftRasterizer::drawSegmentBand(SoftFramebuffer& fb, RasterPoint a, RasterPoint b,
+                                                   double width, unsigned int color, int y0, int y1)
+{
+	double dx = b.x - a.x;
+	double dy = b.y - a.y;
+	if (width > 1.5)
+	{
+		double len = sqrt(dx*dx + dy*dy);
+		if (len == 0)
+			return 0;
+		double nx = -dy / len * width / 2;
+		double ny = dx / len * width / 2;
+		RasterPoint quad[] = {
+			{ a.x + nx, a.y + ny }, { b.x + nx, b.y + ny },
+			{ b.x - nx, b.y - ny }, { a.x - nx, a.y - ny }
+		};
+		return fillPolygonBand(fb, quad, 4, color, y0, y1);
+	}
+
+	double span = max(fabs(dx), fabs(dy));
+	int steps = int(ceil(span));
+	if (steps == 0)
+		steps = 1;
+	unsigned long long pixels = 0;
+	for (int i = 0; i <= steps; i++)
+	{
+		int px = int(floor(a.x + dx * i / steps));
+		int py = int(floor(a.y + dy * i / steps));
+		if (py >= y0 && py < y1 && px >= 0 && px < fb.getWidth())
+		{
+			fb.getRow(py)[px] = color;
+			pixels++;
+		}
+	}
+	return pixels;
+}
+
+// Game drawing.  The shapes mirror the draw routines in GameController.cpp;
+// board coordinates are mapped to pixels with y growing upward.  Flicker
+// uses its own generator so rendering never consumes the game's rand().
+
+namespace
+{
+	struct BoardView
+	{
+		double cell;
+		double originX;
+		double originY;
+
+		RasterPoint toPixel(double x, double y) const
+		{
+			RasterPoint p = { originX + (x + .5) * cell, originY - (y + .5) * cell };
+			return p;
+		}
+	};
+
+	unsigned int s_flickerState = 12345;
+
+	double flicker()
+	{
+		s_flickerState = s_flickerState * 1103515245u + 12345u;
+		return ((s_flickerState >> 16) % 100) / 100.0;
+	}
+
+	  // Like drawPolyFromBaseXY/drawLineFromBaseXY: offsets are half-cell scaled
+	void shapeHalf(SoftRasterizer& r, const BoardView& v, double x, double y,
+	               const RasterPoint pts[], int n, bool fill)
+	{
+		RasterPoint out[8];
+		for (int i = 0; i < n && i < 8; i++)
+			out[i] = v.toPixel(x + .5*(pts[i].x-.5), y + .5*(pts[i].y-.5));
+		if (fill)
+			r.fillPolygon(out, n);
+		else
+			r.drawLineStrip(out, n);
+	}
+
+	  // Like drawPolyFromBaseXYFlat: offsets are whole cells
+	void polyFlat(SoftRasterizer& r, const BoardView& v, double x, double y,
+	              const RasterPoint pts[], int n)
+	{
+		RasterPoint out[8];
+		for (int i = 0; i < n && i < 8; i++)
+			out[i] = v.toPixel(x + pts[i].x - .5, y + pts[i].y - .5);
+		r.fillPolygon(out, n);
+	}
+
+	void ellipse(SoftRasterizer& r, const BoardView& v, double x, double y)
+	{
+		RasterPoint loop[72];
+		for (int i = 0; i < 72; i++)
+		{
+			double theta = i * 5 * PI/180;
+			loop[i] = v.toPixel(x + cos(theta) * .5, y + sin(theta) * .25);
+		}
+		r.drawLineLoop(loop, 72);
+	}
+
+	void softDrawPlayer(SoftRasterizer& r, const BoardView& v, GraphObject*, double x, double y)
+	{
+		r.setColor(.8, .7, .7);
+		r.setLineWidth(1);
+		RasterPoint playertop[] = { { .35, .3 }, { .5, 1 }, { .65, .3 } };
+		polyFlat(r, v, x, y, playertop, 3);
+		RasterPoint playerbot[] = { { .2, .0 }, { .5, .6 }, { .8, .0 } };
+		polyFlat(r, v, x, y, playerbot, 3);
+
+		r.setColor(1, .1, .1);
+		RasterPoint laser1[] = { { .1, .1 }, { .1, .6 } };
+		RasterPoint laser2[] = { { .9, .1 }, { .9, .6 } };
+		shapeHalf(r, v, x, y, laser1, 2, false);
+		shapeHalf(r, v, x, y, laser2, 2, false);
+
+		r.setColor(flicker(), flicker(), flicker());
+		double length = flicker() * .8;
+		RasterPoint exhaust1[] = { { .20, -length }, { .30, 0 }, { .40, -length } };
+		RasterPoint exhaust2[] = { { .80, -length }, { .70, 0 }, { .60, -length } };
+		shapeHalf(r, v, x, y, exhaust1, 3, false);
+		shapeHalf(r, v, x, y, exhaust2, 3, false);
+	}
+
+	void softDrawNachling(SoftRasterizer& r, const BoardView& v, GraphObject*, double x, double y)
+	{
+		r.setColor(1.0, .3, .5);
+		r.setLineWidth(1);
+		ellipse(r, v, x, y);
+		RasterPoint bases[3][4] = {
+			{ { .15, .4 }, { .25, .4 }, { .25, .6 }, { .15, .6 } },
+			{ { .5, .4 }, { .6, .4 }, { .6, .6 }, { .5, .6 } },
+			{ { .8, .4 }, { .9, .4 }, { .9, .6 }, { .8, .6 } },
+		};
+		for (int k = 0; k < 3; k++)
+		{
+			r.setColor(flicker(), flicker(), flicker());
+			shapeHalf(r, v, x, y, bases[k], 4, true);
+		}
+	}
+
+	void softDrawWealthyNachling(SoftRasterizer& r, const BoardView& v, GraphObject* go, double x, double y)
+	{
+		r.setColor(.3, .3, 1.0);
+		r.setLineWidth(2);
+		ellipse(r, v, x, y);
+
+		r.setColor(1.0, 1.0, 1.0);
+		double shift;
+		int anim = (go->getAnimationNumber() % 24) / 2;
+		if (anim < 6)
+			shift = .1 * anim;
+		else
+			shift = .5 - .1 * (anim-6);
+		RasterPoint base[] = { { .1+shift, .4 }, { .4+shift, .4 } , { .4+shift, .6 }, { .1+shift, .6 } };
+		shapeHalf(r, v, x, y, base, 4, true);
+	}
+
+	void softDrawSmallbot(SoftRasterizer& r, const BoardView& v, GraphObject*, double x, double y)
+	{
+		r.setColor(0, .8, 0.8);
+		r.setLineWidth(1);
+		RasterPoint ship[] = { { 0, 1 }, { .5, 0 }, { 1, 1 } };
+		shapeHalf(r, v, x, y, ship, 3, true);
+
+		r.setColor(flicker(), flicker(), flicker());
+		double length = flicker() * .7;
+		RasterPoint exhaust1[] = { { .20, 1+length }, { .30, 1.0 }, { .40, 1+length } };
+		RasterPoint exhaust2[] = { { .80, 1+length }, { .70, 1.0 }, { .60, 1+length } };
+		shapeHalf(r, v, x, y, exhaust1, 3, false);
+		shapeHalf(r, v, x, y, exhaust2, 3, false);
+	}
+
+	void softDrawBullet(SoftRasterizer& r, const BoardView& v, GraphObject*, double x, double y)
+	{
+		r.setColor(1.0, 0, 0);
+		r.setLineWidth(1);
+		RasterPoint bullet[] = { { .4, .5 }, { .5, .6 }, { .6, .5 }, { .5, .4 } };
+		shapeHalf(r, v, x, y, bullet, 4, true);
+	}
+
+	void softDrawGoodie(SoftRasterizer& r, const BoardView& v, GraphObject* go, double x, double y)
+	{
+		double brightness = go->getBrightness();
+		r.setColor(0, 0, brightness);
+		r.setLineWidth(1);
+		RasterPoint circle[10];
+		for (int i = 0; i < 10; i++)
+		{
+			double theta = 2*PI * i / 10.0;
+			circle[i] = v.toPixel(x + cos(theta) * .46, y + sin(theta) * .46);
+		}
+		r.fillPolygon(circle, 10);
+
+		char goodieChar[2] = "";
+		switch (go->getID())
+		{
+			case IID_FREE_SHIP_GOODIE: goodieChar[0] = 'F'; break;
+			case IID_ENERGY_GOODIE:    goodieChar[0] = 'E'; break;
+			case IID_TORPEDO_GOODIE:   goodieChar[0] = 'T'; break;
+		}
+		r.setColor(1.0*brightness, 0.2*brightness, 0.3*brightness);
+		RasterPoint at = v.toPixel(x - .2, y - .3);
+		r.drawStrokeText(at.x, at.y, .6 * v.cell, goodieChar);
+	}
+
+	void softDrawTorpedo(SoftRasterizer& r, const BoardView& v, GraphObject*, double x, double y)
+	{
+		r.setColor(1.0, 0, 0);
+		r.setLineWidth(1);
+		double length = flicker();
+		for (int i = 0; i < 5; i++)
+		{
+			double theta = 2*PI * flicker();
+			RasterPoint line[] = { { .5, .5 }, { cos(theta) * length + .5, sin(theta) * length + .5 } };
+			shapeHalf(r, v, x, y, line, 2, false);
+		}
+	}
+
+	void softDrawStarField(SoftRasterizer& r, const BoardView& v, const StarField& stars, double tickFraction)
+	{
+		r.setLineWidth(1);
+		for (int k = 0; k < stars.size(); k++)
+		{
+			double y = stars.getPrevY(k) + (stars.getY(k) - stars.getPrevY(k)) * tickFraction;
+			double brightness = max(flicker(), .2);
+			r.setColor(brightness, brightness, brightness);
+			double length = flicker() / 5;
+			for (int i = 0; i < 5; i++)
+			{
+				double theta = 2*PI * flicker();
+				RasterPoint line[] = { { .5, .5 }, { cos(theta) * length + .5, sin(theta) * length + .5 } };
+				shapeHalf(r, v, stars.getX(k), y, line, 2, false);
+			}
+		}
+	}
+
+	void softDrawEffects(SoftRasterizer& r, const BoardView& v, const EffectPool& effects, double tickFraction)
+	{
+		r.setLineWidth(1);
+		for (int i = 0; i < EffectPool::CAPACITY; i++)
+		{
+			if (!effects.isAlive(i))
+				continue;
+			double dx = effects.getX(i) - effects.getPrevX(i);
+			double dy = effects.getY(i) - effects.getPrevY(i);
+			double x = effects.getPrevX(i) + dx * tickFraction;
+			double y = effects.getPrevY(i) + dy * tickFraction;
+			float red, green, blue;
+			effects.getColor(i, red, green, blue);
+			r.setColor(red, green, blue);
+			RasterPoint line[] = { v.toPixel(x, y), v.toPixel(x - dx/2, y - dy/2) };
+			r.drawLineStrip(line, 2);
+		}
+	}
+}
+
+void softRenderFrame(SoftRasterizer& raster, SoftFramebuffer& fb,
+                     const set<GraphObject*>& graphObjects, const StarField* stars,
+                     const EffectPool* effects, const string& statText,
+                     double tickFraction, const string& overlayText)
+{
+	static const double STAT_ROWS = 3;   // board cells reserved above the board for the status line
+
+	BoardView view;
+	view.cell = min(fb.getWidth() / double(VIEW_WIDTH), fb.getHeight() / (VIEW_HEIGHT + STAT_ROWS));
+	view.originX = (fb.getWidth() - VIEW_WIDTH * view.cell) / 2;
+	view.originY = fb.getHeight();
+
+	raster.clear(0xff000000u);
+	for (set<GraphObject*>::const_iterator it = graphObjects.begin(); it != graphObjects.end(); it++)
+	{
+		GraphObject* cur = *it;
+		if (!cur->isVisible())
+			continue;
+		cur->animate(tickFraction);
+		double x, y;
+		cur->getAnimationLocation(x, y);
+		switch (cur->getID())
+		{
+			case IID_PLAYER_SHIP:      softDrawPlayer(raster, view, cur, x, y);          break;
+			case IID_NACHLING:         softDrawNachling(raster, view, cur, x, y);        break;
+			case IID_WEALTHY_NACHLING: softDrawWealthyNachling(raster, view, cur, x, y); break;
+			case IID_SMALLBOT:         softDrawSmallbot(raster, view, cur, x, y);        break;
+			case IID_BULLET:           softDrawBullet(raster, view, cur, x, y);          break;
+			case IID_FREE_SHIP_GOODIE:
+			case IID_ENERGY_GOODIE:
+			case IID_TORPEDO_GOODIE:   softDrawGoodie(raster, view, cur, x, y);          break;
+			case IID_TORPEDO:          softDrawTorpedo(raster, view, cur, x, y);         break;
+		}
+	}
+	double fraction = min(max(tickFraction, 0.0), 1.0);
+	if (stars != NULL)
+		softDrawStarField(raster, view, *stars, fraction);
+	if (effects != NULL  &&  effects->getNumAlive() > 0)
+		softDrawEffects(raster, view, *effects, fraction);
+
+	double textHeight = view.cell * .8;
+	raster.setColor(.8, .8, .8);
+	raster.setLineWidth(1);
+	raster.drawStrokeText((fb.getWidth() - raster.strokeTextWidth(textHeight, statText.c_str())) / 2,
+	                      view.cell * 2, textHeight, statText.c_str());
+	if (!overlayText.empty())
+		raster.drawStrokeText((fb.getWidth() - raster.strokeTextWidth(textHeight, overlayText.c_str())) / 2,
+		                      fb.getHeight() - view.cell * .5, textHeight, overlayText.c_str());
+	raster.flush(fb);
+}
@@ -0,0 +1,145 @@
+#ifndef _SOFTRASTER_H_
+#define _SOFTRASTER_H_
+
+#include <vector>
+#include <string>
+#include <set>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+// A CPU rasterizer for the handful of primitives the game draws: filled
+// polygons, line strips/loops and stroke text.  It has no dependency on
+// OpenGL or GLUT; pixels are 32-bit RGBA (R in the low byte), row 0 at top.
+
+class GraphObject;
+class StarField;
+class EffectPool;
+
+struct RasterPoint
+{
+	double x;
+	double y;
+};
+
+class SoftFramebuffer
+{
+  public:
+	SoftFramebuffer(int width, int height);
+
+	void resize(int width, int height);
+	void clear(unsigned int rgba);
+
+	int getWidth() const
+	{
+		return m_width;
+	}
+
+	int getHeight() const
+	{
+		return m_height;
+	}
+
+	unsigned int* getRow(int y)
+	{
+		return &m_pixels[y * m_width];
+	}
+
+	const unsigned int* getPixels() const
+	{
+		return m_pixels.empty() ? NULL : &m_pixels[0];
+	}
+
+  private:
+	int m_width;
+	int m_height;
+	std::vector<unsigned int> m_pixels;
+};
+
+// Draw calls are recorded into a command list and rasterized by flush().
+// With more than one thread the framebuffer is split into horizontal bands
+// of tiles; each worker replays the whole list clipped to its own bands, so
+// the result is identical to the single-threaded one.
+class SoftRasterizer
+{
+  public:
+	SoftRasterizer();
+	~SoftRasterizer();
+
+	void setThreadCount(int n);
+	void setColor(double r, double g, double b);
+	void setLineWidth(double w);
+
+	void clear(unsigned int rgba);
+
+	void fillPolygon(const RasterPoint points[], int nPoints);
+	void drawLineStrip(const RasterPoint points[], int nPoints);
+	void drawLineLoop(const RasterPoint points[], int nPoints);
+	void drawStrokeText(double x, double y, double height, const char* str);
+	double strokeTextWidth(double height, const char* str) const;
+
+	void flush(SoftFramebuffer& fb);
+
+	  // Work done by the last flush(), for benchmarking
+	unsigned int getCommandCount() const
+	{
+		return m_lastCommands;
+	}
+
+	unsigned long long getPixelsWritten() const
+	{
+		return m_lastPixels;
+	}
+
+  private:
+	enum CommandType { CLEAR, FILL_POLYGON, LINE_STRIP, LINE_LOOP };
+
+	struct Command
+	{
+		CommandType  type;
+		unsigned int color;
+		double       lineWidth;
+		int          firstVertex;
+		int          nVertices;
+	};
+
+	void addCommand(CommandType type, const RasterPoint points[], int nPoints);
+	unsigned long long rasterizeBand(SoftFramebuffer& fb, int y0, int y1);
+	unsigned long long fillPolygonBand(SoftFramebuffer& fb, const RasterPoint* pts, int n,
+	                                   unsigned int color, int y0, int y1);
+	unsigned long long drawSegmentBand(SoftFramebuffer& fb, RasterPoint a, RasterPoint b,
+	                                   double width, unsigned int color, int y0, int y1);
+	void workerLoop(int index, unsigned int generation);
+
+	std::vector<Command>     m_commands;
+	std::vector<RasterPoint> m_vertices;
+	unsigned int             m_color;
+	double                   m_lineWidth;
+	unsigned int             m_lastCommands;
+	unsigned long long       m_lastPixels;
+
+	  // Tile-parallel workers; worker 0 is the thread that calls flush()
+	std::vector<std::thread> m_workers;
+	std::mutex               m_mutex;
+	std::condition_variable  m_wake;
+	std::condition_variable  m_done;
+	SoftFramebuffer*         m_target;
+	unsigned int             m_generation;
+	int                      m_pending;
+	bool                     m_shutdown;
+	std::vector<unsigned long long> m_workerPixels;
+
+	SoftRasterizer(const SoftRasterizer&);
+	SoftRasterizer& operator=(const SoftRasterizer&);
+};
+
+// Draws every visible GraphObject, the star field and debris (either may be
+// NULL) and the status line the same way the OpenGL path in GameController
+// does, but into a SoftFramebuffer.  tickFraction is passed to
+// GraphObject::animate; a non-empty overlayText is drawn along the bottom edge.
+void softRenderFrame(SoftRasterizer& raster, SoftFramebuffer& fb,
+                     const std::set<GraphObject*>& graphObjects, const StarField* stars,
+                     const EffectPool* effects, const std::string& statText,
+                     double tickFraction, const std::string& overlayText = "");
+
+#endif // _SOFTRASTER_H_
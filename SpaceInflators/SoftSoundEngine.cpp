@@ -0,0 +1,98 @@
+#include "SoftSoundEngine.h"
+#include "AudioSink.h"
+#include <fstream>
+#include <iostream>
+#include <vector>
+#include <chrono>
+#include <cstdlib>
+using namespace std;
+
+SoftSoundEngine* SoftSoundEngine::create()
+{
+	const char* spec = getenv("SPACEINFLATORS_AUDIO");
+	return new SoftSoundEngine(createAudioSink(spec != NULL ? spec : ""));
+}
+
+SoftSoundEngine::SoftSoundEngine(AudioSink* sink)
+ : m_sink(sink), m_stopping(false)
+{
+	m_thread = thread(&SoftSoundEngine::run, this);
+}
+
+SoftSoundEngine::~SoftSoundEngine()
+{
+	m_stopping.store(true, memory_order_release);
+	m_thread.join();
+	delete m_sink;
+}
+
+void SoftSoundEngine::drop()
+{
+	delete this;
+}
+
+SoftSoundSource* SoftSoundEngine::addSoundSourceFromMemory(void* memory, int sizeInBytes, const char* soundName,
+                                                           bool)
+{
+	map<string, CachedClip>::iterator p = m_clips.find(soundName);
+	if (p != m_clips.end())
+		return &p->second.source;   // a voice may be playing the old one
+	CachedClip& cached = m_clips[soundName];
+	if (!decodeWav(static_cast<const char*>(memory), sizeInBytes, cached.clip))
+		cout << "Cannot decode " << soundName << "; it will be silent." << endl;
+	return &cached.source;
+}
+
+void SoftSoundEngine::play2D(const char* soundFile, bool)
+{
+	map<string, CachedClip>::iterator p = m_clips.find(soundFile);
+	if (p == m_clips.end())
+	{
+		  // Not preloaded: read it now, on the caller's thread
+		ifstream in(soundFile, ios::binary);
+		vector<char> data((istreambuf_iterator<char>(in)), istreambuf_iterator<char>());
+		addSoundSourceFromMemory(data.empty() ? NULL : &data[0], int(data.size()), soundFile, true);
+		p = m_clips.find(soundFile);
+	}
+	lock_guard<mutex> lock(m_mixerMutex);
+	m_mixer.play(&p->second.clip);
+}
+
+void SoftSoundEngine::stopAllSounds()
+{
+	lock_guard<mutex> lock(m_mixerMutex);
+	m_mixer.stopAll();
+}
+
+void SoftSoundEngine::setSoundVolume(float volume)
+{
+	lock_guard<mutex> lock(m_mixerMutex);
+	m_mixer.setVolume(volume);
+}
+
+void SoftSoundEngine::run()
+{
+	short block[MIXER_BLOCK * MIXER_CHANNELS];
+	chrono::steady_clock::time_point next = chrono::steady_clock::now();
+	bool sinkOk = true;
+	while (!m_stopping.load(memory_order_acquire))
+	{
+		{
+			lock_guard<mutex> lock(m_mixerMutex);
+			m_mixer.mix(block, MIXER_BLOCK);
+		}
+		if (sinkOk && !m_sink->write(block, MIXER_BLOCK))
+		{
+			cout << "Audio output failed; sound is off." << endl;
+			sinkOk = false;
+		}
+
+		  // A sink that blocked for a long time puts us behind; start over
+		  // from now rather than rushing to catch up
+		next += chrono::milliseconds(1000 * MIXER_BLOCK / MIXER_RATE);
+		chrono::steady_clock::time_point now = chrono::steady_clock::now();
+		if (now > next + chrono::milliseconds(100))
+			next = now;
+		this_thread::sleep_until(next);
+	}
+}
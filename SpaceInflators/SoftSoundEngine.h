@@ -0,0 +1,58 @@
+#ifndef _SOFTSOUNDENGINE_H_
+#define _SOFTSOUNDENGINE_H_
+
+#include "SoundMixer.h"
+#include <string>
+#include <map>
+#include <thread>
+#include <mutex>
+#include <atomic>
+
+class AudioSink;
+
+class SoftSoundSource
+{
+  public:
+	void setStreamMode(int) {}   // clips are always decoded up front
+};
+
+// The irrKlang calls SoundFXController makes, built on decodeWav,
+// SoundMixer and an AudioSink, for platforms with no irrKlang.  Clips are
+// decoded once and cached by name.  A mixer thread renders a 10 ms block
+// at a time into the sink named by the SPACEINFLATORS_AUDIO environment
+// variable (see createAudioSink), pacing itself by the clock.
+class SoftSoundEngine
+{
+  public:
+	static SoftSoundEngine* create();
+
+	void play2D(const char* soundFile, bool playLooped);   // looping isn't supported
+	void stopAllSounds();
+	void setSoundVolume(float volume);
+	SoftSoundSource* addSoundSourceFromMemory(void* memory, int sizeInBytes, const char* soundName,
+	                                          bool copyMemory);
+	void drop();   // stop the mixer and delete the engine
+
+  private:
+	SoftSoundEngine(AudioSink* sink);
+	~SoftSoundEngine();
+	SoftSoundEngine(const SoftSoundEngine&);
+	SoftSoundEngine& operator=(const SoftSoundEngine&);
+
+	struct CachedClip
+	{
+		SoundClip       clip;
+		SoftSoundSource source;
+	};
+
+	void run();   // body of the mixer thread
+
+	std::map<std::string, CachedClip> m_clips;   // only touched by the caller's thread
+	SoundMixer        m_mixer;
+	std::mutex        m_mixerMutex;              // guards m_mixer
+	AudioSink*        m_sink;
+	std::thread       m_thread;
+	std::atomic<bool> m_stopping;
+};
+
+#endif // _SOFTSOUNDENGINE_H_
@@ -0,0 +1,165 @@
+#include "SoundFX.h"
+#include <fstream>
+#include <cstring>
+#include <cstdlib>
+#include <chrono>
+using namespace std;
+
+SoundFXController::SoundFXController()
+ : m_stopping(false), m_dropped(0), m_engine(NULL), m_preloadTime(0)
+{
+}
+
+SoundFXController::~SoundFXController()
+{
+	if (m_audioThread.joinable())
+	{
+		m_stopping.store(true, memory_order_release);
+		m_audioThread.join();
+	}
+	if (m_engine != NULL)
+		m_engine->drop();
+}
+
+void SoundFXController::preload(const vector<string>& soundFiles)
+{
+	start(soundFiles);
+}
+
+void SoundFXController::start(const vector<string>& soundFiles)
+{
+	if (m_audioThread.joinable())
+		return;
+	m_preloadFiles = soundFiles;
+	m_audioThread = thread(&SoundFXController::run, this);
+	atexit(writeSummaryAtExit);
+}
+
+void SoundFXController::playClip(const string& soundFile)
+{
+	if (soundFile.size() >= MAX_CLIP_NAME)
+	{
+		m_dropped.fetch_add(1, memory_order_relaxed);
+		return;
+	}
+	SoundCommand command;
+	command.kind = SoundCommand::PLAY;
+	strcpy(command.clip, soundFile.c_str());
+	send(command);
+}
+
+void SoundFXController::abortClip()
+{
+	SoundCommand command;
+	command.kind = SoundCommand::STOP_ALL;
+	send(command);
+}
+
+void SoundFXController::setVolume(float volume)
+{
+	SoundCommand command;
+	command.kind = SoundCommand::SET_VOLUME;
+	command.volume = volume < 0 ? 0 : (volume > 1 ? 1 : volume);
+	send(command);
+}
+
+void SoundFXController::send(SoundCommand& command)
+{
+	if (!m_audioThread.joinable())
+		start(vector<string>());
+	command.timestamp = Telemetry::now();
+	if (!m_commands.push(command))
+		m_dropped.fetch_add(1, memory_order_relaxed);
+}
+
+  // The ring has no way to wake a sleeping consumer without the producer
+  // taking a lock, so an idle audio thread polls every millisecond
+void SoundFXController::run()
+{
+	loadClips();
+	while (!m_stopping.load(memory_order_acquire))
+	{
+		SoundCommand command;
+		if (!m_commands.pop(command))
+		{
+			this_thread::sleep_for(chrono::milliseconds(1));
+			continue;
+		}
+		{
+			lock_guard<mutex> lock(m_statsMutex);
+			m_queueLatency.record(Telemetry::now() - command.timestamp);
+		}
+		execute(command);
+	}
+}
+
+  // Read the files in parallel while the device starts up, then hand them to
+  // irrKlang under their file names so play2D finds them already in memory
+void SoundFXController::loadClips()
+{
+	long long start = Telemetry::now();
+	vector< vector<char> > data(m_preloadFiles.size());
+	vector<thread> readers;
+	for (size_t k = 0; k < m_preloadFiles.size(); k++)
+		readers.push_back(thread(readClip, m_preloadFiles[k], &data[k]));
+	m_engine = irrklang::createIrrKlangDevice();
+	if (m_engine == NULL)
+		cout << "Cannot create sound engine!  Game will be silent." << endl;
+	for (size_t k = 0; k < readers.size(); k++)
+		readers[k].join();
+
+	if (m_engine != NULL)
+	{
+		for (size_t k = 0; k < data.size(); k++)
+		{
+			if (data[k].empty())
+				continue;
+			irrklang::ISoundSource* source = m_engine->addSoundSourceFromMemory(
+				&data[k][0], int(data[k].size()), m_preloadFiles[k].c_str(), true);
+			if (source != NULL)
+				source->setStreamMode(irrklang::ESM_NO_STREAMING);
+		}
+	}
+	lock_guard<mutex> lock(m_statsMutex);
+	m_preloadTime = Telemetry::now() - start;
+}
+
+void SoundFXController::readClip(string soundFile, vector<char>* data)
+{
+	ifstream in(soundFile.c_str(), ios::binary);
+	if (!in)
+		return;
+	in.seekg(0, ios::end);
+	streamoff size = in.tellg();
+	in.seekg(0, ios::beg);
+	if (size <= 0)
+		return;
+	data->resize(size_t(size));
+	if (!in.read(&(*data)[0], size))
+		data->clear();
+}
+
+void SoundFXController::execute(const SoundCommand& command)
+{
+	if (m_engine == NULL)
+		return;
+	switch (command.kind)
+	{
+		case SoundCommand::PLAY:       m_engine->play2D(command.clip, false);     break;
+		case SoundCommand::STOP_ALL:   m_engine->stopAllSounds();                 break;
+		case SoundCommand::SET_VOLUME: m_engine->setSoundVolume(command.volume);  break;
+	}
+}
+
+void SoundFXController::writeSummary(ostream& os)
+{
+	lock_guard<mutex> lock(m_statsMutex);
+	os << "Sound: " << m_preloadFiles.size() << " clips preloaded in " << m_preloadTime / 1000.0 << " ms, "
+	   << m_dropped.load(memory_order_relaxed) << " commands dropped" << endl;
+	m_queueLatency.writeSummary(os, "sound queue");
+}
+
+void SoundFXController::writeSummaryAtExit()
+{
+	getInstance().writeSummary(cout);
+}
@@ -8,6 +8,25 @@
 #elif !defined(unix)
 #include <irrKlang.h>
 #pragma comment(lib, "irrKlang.lib") // link with irrKlang.dll
+#else
+
+// No irrKlang on Linux: use the built-in WAV decoder and mixer, which
+// provide the calls SoundFXController makes
+#include "SoftSoundEngine.h"
+
+namespace irrklang
+{
+	enum E_STREAM_MODE { ESM_AUTO_DETECT, ESM_STREAMING, ESM_NO_STREAMING };
+
+	typedef SoftSoundEngine ISoundEngine;
+	typedef SoftSoundSource ISoundSource;
+
+	inline ISoundEngine* createIrrKlangDevice()
+	{
+		return SoftSoundEngine::create();
+	}
+}
+
 #endif
 
 #else // forget about using sound library
@@ -16,14 +35,23 @@
 
 namespace irrklang
 {
+	enum E_STREAM_MODE { ESM_AUTO_DETECT, ESM_STREAMING, ESM_NO_STREAMING };
+
+	struct ISoundSource
+	{
+		void setStreamMode(E_STREAM_MODE) {}
+	};
+
 	struct ISoundEngine
 	{
 		void play2D(std::string, bool) {}
 		void stopAllSounds() {}
+		void setSoundVolume(float) {}
 		void drop() {}
+		ISoundSource* addSoundSourceFromMemory(void*, int, const char*, bool) { return NULL; }
 	};
 
-	ISoundEngine* createIrrKlangDevice()
+	inline ISoundEngine* createIrrKlangDevice()
 	{
 		static ISoundEngine instance;
 		return &instance;
@@ -32,24 +60,47 @@ namespace irrklang
 
 #endif // NOSOUND
 
-#include <iostream>
+#include "SpscRing.h"
+#include "Telemetry.h"
 #include <string>
+#include <vector>
+#include <thread>
+#include <atomic>
+#include <mutex>
+#include <iostream>
 
+const int MAX_CLIP_NAME = 32;   // longest clip file name, with its terminator
+const unsigned int SOUND_QUEUE_CAPACITY = 64;
+
+// A request from the game thread to the audio thread
+struct SoundCommand
+{
+	enum Kind { PLAY, STOP_ALL, SET_VOLUME };
+
+	Kind      kind;
+	char      clip[MAX_CLIP_NAME];   // for PLAY
+	float     volume;                // for SET_VOLUME, 0 to 1
+	long long timestamp;             // Telemetry::now() when queued
+};
+
+// Plays the game's sound clips on an audio thread of its own.  playClip,
+// abortClip and setVolume only push a command into a single-producer ring,
+// which never blocks, so the game thread never waits on the audio driver
+// or the disk; a full ring drops the command.  The thread starts on first
+// use, or earlier with preload(), which also creates the irrKlang device
+// and reads every clip into memory while the window is being set up.
 class SoundFXController
 {
   public:
+    void preload(const std::vector<std::string>& soundFiles);
 
-    void playClip(std::string soundFile)
-    {
-        if (m_engine != NULL)
-            m_engine->play2D(soundFile.c_str(), false);
-    }
+    void playClip(const std::string& soundFile);
+    void abortClip();
+    void setVolume(float volume);
 
-    void abortClip()
-    {
-        if (m_engine != NULL)
-            m_engine->stopAllSounds();
-    }
+      // Queue latency, drops and preload time, printed at exit once the
+      // audio thread has started
+    void writeSummary(std::ostream& os);
 
       // Meyers singleton pattern
     static SoundFXController& getInstance()
@@ -59,24 +110,32 @@ class SoundFXController
     }
 
   private:
-    SoundFXController()
-    {
-        m_engine = irrklang::createIrrKlangDevice();
-        if (m_engine == NULL)
-            std::cout << "Cannot create sound engine!  Game will be silent."
-                      << std::endl;
-    }
-
-    ~SoundFXController()
-    {
-        if (m_engine != NULL)
-            m_engine->drop();
-    }
-
+    SoundFXController();
+    ~SoundFXController();
     SoundFXController(const SoundFXController&);
     SoundFXController& operator=(const SoundFXController&);
 
-    irrklang::ISoundEngine* m_engine;
+    void start(const std::vector<std::string>& soundFiles);
+    void send(SoundCommand& command);
+    void run();           // body of the audio thread
+    void loadClips();
+    void execute(const SoundCommand& command);
+    static void readClip(std::string soundFile, std::vector<char>* data);
+    static void writeSummaryAtExit();
+
+      // Game thread
+    SpscRing<SoundCommand, SOUND_QUEUE_CAPACITY> m_commands;
+    std::thread              m_audioThread;
+    std::atomic<bool>        m_stopping;
+    std::atomic<unsigned long long> m_dropped;
+
+      // Audio thread
+    irrklang::ISoundEngine*  m_engine;
+    std::vector<std::string> m_preloadFiles;   // set before the thread starts
+
+    std::mutex               m_statsMutex;     // guards the two below
+    LatencyHistogram         m_queueLatency;
+    long long                m_preloadTime;
 };
 
 inline SoundFXController& SoundFX()
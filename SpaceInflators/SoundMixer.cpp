@@ -0,0 +1,173 @@
+#include "SoundMixer.h"
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define SOUNDMIXER_SSE2
+#include <emmintrin.h>
+#endif
+
+namespace
+{
+	unsigned int readLE(const unsigned char* p, int bytes)
+	{
+		unsigned int v = 0;
+		for (int k = bytes - 1; k >= 0; k--)
+			v = (v << 8) | p[k];
+		return v;
+	}
+
+	  // One channel of one source frame as a 16-bit sample
+	int sourceSample(const unsigned char* frame, int channel, int bits)
+	{
+		if (bits == 8)
+			return (int(frame[channel]) - 128) << 8;   // 8-bit WAV data is unsigned
+		return short(readLE(frame + 2 * channel, 2));
+	}
+}
+
+bool decodeWav(const char* data, size_t size, SoundClip& clip)
+{
+	const unsigned char* p = reinterpret_cast<const unsigned char*>(data);
+	if (size < 12 || memcmp(p, "RIFF", 4) != 0 || memcmp(p + 8, "WAVE", 4) != 0)
+		return false;
+
+	int channels = 0, rate = 0, bits = 0;
+	const unsigned char* pcm = NULL;
+	size_t pcmBytes = 0;
+	size_t offset = 12;
+	while (offset + 8 <= size)
+	{
+		size_t chunkSize = readLE(p + offset + 4, 4);
+		const unsigned char* body = p + offset + 8;
+		size_t available = size - offset - 8;
+		if (memcmp(p + offset, "fmt ", 4) == 0 && chunkSize >= 16 && available >= 16)
+		{
+			if (readLE(body, 2) != 1)   // only uncompressed PCM
+				return false;
+			channels = readLE(body + 2, 2);
+			rate = readLE(body + 4, 4);
+			bits = readLE(body + 14, 2);
+		}
+		else if (memcmp(p + offset, "data", 4) == 0)
+		{
+			pcm = body;
+			pcmBytes = chunkSize < available ? chunkSize : available;   // tolerate a truncated file
+		}
+		offset += 8 + chunkSize + (chunkSize & 1);   // chunks are padded to even sizes
+	}
+	if (pcm == NULL || (channels != 1 && channels != 2) || (bits != 8 && bits != 16) || rate <= 0)
+		return false;
+
+	  // Resample with linear interpolation, stepping through the source in
+	  // 16.16 fixed point
+	int frameBytes = channels * bits / 8;
+	long long sourceFrames = pcmBytes / frameBytes;
+	if (sourceFrames == 0)
+	{
+		clip.samples.clear();
+		return true;
+	}
+	long long frames = sourceFrames * MIXER_RATE / rate;
+	unsigned long long step = ((unsigned long long)(rate) << 16) / MIXER_RATE;
+	clip.samples.resize(size_t(frames) * MIXER_CHANNELS);
+	for (long long f = 0; f < frames; f++)
+	{
+		unsigned long long pos = f * step;
+		long long i = pos >> 16;
+		int frac = int(pos & 0xffff);
+		const unsigned char* a = pcm + i * frameBytes;
+		const unsigned char* b = i + 1 < sourceFrames ? a + frameBytes : a;
+		for (int c = 0; c < MIXER_CHANNELS; c++)
+		{
+			int channel = channels == 2 ? c : 0;
+			int sa = sourceSample(a, channel, bits);
+			int sb = sourceSample(b, channel, bits);
+			clip.samples[size_t(f) * MIXER_CHANNELS + c] = short(sa + (((sb - sa) * frac) >> 16));
+		}
+	}
+	return true;
+}
+
+SoundMixer::SoundMixer()
+ : m_numVoices(0), m_volume(1), m_stolen(0)
+{
+}
+
+void SoundMixer::play(const SoundClip* clip)
+{
+	if (clip == NULL || clip->samples.empty())
+		return;
+	if (m_numVoices == MAX_VOICES)
+	{
+		memmove(m_voices, m_voices + 1, (MAX_VOICES - 1) * sizeof(Voice));
+		m_numVoices--;
+		m_stolen++;
+	}
+	m_voices[m_numVoices].clip = clip;
+	m_voices[m_numVoices].position = 0;
+	m_numVoices++;
+}
+
+void SoundMixer::stopAll()
+{
+	m_numVoices = 0;
+}
+
+void SoundMixer::setVolume(float volume)
+{
+	m_volume = volume < 0 ? 0 : (volume > 1 ? 1 : volume);
+}
+
+void SoundMixer::mix(short* out, int frames)
+{
+	int samples = frames * MIXER_CHANNELS;
+	memset(m_accum, 0, samples * sizeof(int));
+
+	int kept = 0;
+	for (int v = 0; v < m_numVoices; v++)
+	{
+		Voice& voice = m_voices[v];
+		const short* src = &voice.clip->samples[0] + voice.position;
+		int remaining = int(voice.clip->samples.size()) - voice.position;
+		int n = remaining < samples ? remaining : samples;
+		int i = 0;
+#ifdef SOUNDMIXER_SSE2
+		for ( ; i + 8 <= n; i += 8)
+		{
+			  // Sign-extend eight samples to 32 bits and add them in
+			__m128i s = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+			__m128i lo = _mm_srai_epi32(_mm_unpacklo_epi16(s, s), 16);
+			__m128i hi = _mm_srai_epi32(_mm_unpackhi_epi16(s, s), 16);
+			__m128i* acc = reinterpret_cast<__m128i*>(m_accum + i);
+			_mm_storeu_si128(acc, _mm_add_epi32(_mm_loadu_si128(acc), lo));
+			_mm_storeu_si128(acc + 1, _mm_add_epi32(_mm_loadu_si128(acc + 1), hi));
+		}
+#endif
+		for ( ; i < n; i++)
+			m_accum[i] += src[i];
+		voice.position += n;
+		if (n == remaining)
+			continue;   // finished
+		m_voices[kept++] = voice;
+	}
+	m_numVoices = kept;
+
+	int i = 0;
+#ifdef SOUNDMIXER_SSE2
+	__m128 volume = _mm_set1_ps(m_volume);
+	  // Truncate, as the scalar loop's int() does, so both give the same samples
+	for ( ; i + 8 <= samples; i += 8)
+	{
+		__m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(m_accum + i));
+		__m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(m_accum + i + 4));
+		a = _mm_cvttps_epi32(_mm_mul_ps(_mm_cvtepi32_ps(a), volume));
+		b = _mm_cvttps_epi32(_mm_mul_ps(_mm_cvtepi32_ps(b), volume));
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), _mm_packs_epi32(a, b));   // saturates
+	}
+#endif
+	for ( ; i < samples; i++)
+	{
+		int s = int(m_accum[i] * m_volume);
+		out[i] = short(s > 32767 ? 32767 : (s < -32768 ? -32768 : s));
+	}
+}
@@ -0,0 +1,68 @@
+#ifndef _SOUNDMIXER_H_
+#define _SOUNDMIXER_H_
+
+#include <vector>
+#include <cstddef>
+
+const int MIXER_RATE     = 44100;   // frames per second
+const int MIXER_CHANNELS = 2;
+const int MIXER_BLOCK    = MIXER_RATE / 100;   // frames in a 10 ms block
+
+// A clip decoded to the mixer's format: 16-bit stereo at MIXER_RATE,
+// interleaved left then right.
+struct SoundClip
+{
+	std::vector<short> samples;
+
+	int getFrames() const
+	{
+		return int(samples.size() / MIXER_CHANNELS);
+	}
+};
+
+// Decode a PCM WAV file (8 or 16 bits, mono or stereo, any rate) into
+// the mixer's format.  Returns false if the data isn't a WAV we can play.
+bool decodeWav(const char* data, std::size_t size, SoundClip& clip);
+
+// Mixes up to MAX_VOICES clips into 16-bit stereo blocks.  Voices add up
+// in 32 bits and are scaled by the master volume and saturated once per
+// block, so a loud mix clips instead of wrapping around.  Playing a clip
+// when every voice is busy replaces the voice that started first.  Not
+// thread-safe: the owner serializes play(), stopAll() and mix().
+class SoundMixer
+{
+  public:
+	static const int MAX_VOICES = 16;
+
+	SoundMixer();
+
+	void play(const SoundClip* clip);   // the clip must outlive its voice
+	void stopAll();
+	void setVolume(float volume);       // 0 to 1
+	void mix(short* out, int frames);   // frames at most MIXER_BLOCK
+
+	int getNumVoices() const
+	{
+		return m_numVoices;
+	}
+
+	unsigned long long getStolenVoices() const
+	{
+		return m_stolen;
+	}
+
+  private:
+	struct Voice
+	{
+		const SoundClip* clip;
+		int              position;   // next sample (not frame) to mix
+	};
+
+	Voice              m_voices[MAX_VOICES];   // oldest first
+	int                m_numVoices;
+	float              m_volume;
+	unsigned long long m_stolen;
+	int                m_accum[MIXER_BLOCK * MIXER_CHANNELS];
+};
+
+#endif // _SOUNDMIXER_H_
@@ -0,0 +1,96 @@
+#include "SpaceInflatorsC.h"
+#include "AgentEnv.h"
+#include <new>
+
+struct si_world
+{
+	AgentEnv         env;
+	AgentObservation obs;
+};
+
+namespace
+{
+	  // The C action values must match AgentEnv's; each line fails to
+	  // compile if they drift apart
+	typedef char CheckLeft[SI_ACTION_LEFT == ACTION_LEFT ? 1 : -1];
+	typedef char CheckDown[SI_ACTION_DOWN == ACTION_DOWN ? 1 : -1];
+	typedef char CheckFire[SI_ACTION_FIRE == ACTION_FIRE ? 1 : -1];
+	typedef char CheckTorpedo[SI_ACTION_TORPEDO == ACTION_TORPEDO ? 1 : -1];
+}
+
+int si_abi_version(void)
+{
+	return SI_ABI_VERSION;
+}
+
+si_world* si_create(void)
+{
+	return new (std::nothrow) si_world;
+}
+
+void si_destroy(si_world* world)
+{
+	delete world;
+}
+
+void si_reset(si_world* world, unsigned int seed)
+{
+	world->env.reset(seed, world->obs);
+}
+
+int si_step(si_world* world, int action, int* reward)
+{
+	AgentStepResult r = world->env.step(action, world->obs);
+	if (reward != NULL)
+		*reward = r.reward;
+	return (r.lifeLost ? SI_STEP_LIFE_LOST : 0) | (r.done ? SI_STEP_DONE : 0);
+}
+
+void si_get_state(const si_world* world, si_state* state)
+{
+	const AgentObservation& obs = world->obs;
+	state->player_x = obs.playerX;
+	state->player_y = obs.playerY;
+	state->player_energy = obs.playerEnergy;
+	state->torpedoes = obs.torpedoes;
+	state->lives = obs.lives;
+	state->round = obs.round;
+	state->score = obs.score;
+	state->num_entities = int(obs.entities.size());
+}
+
+int si_get_entities(const si_world* world, si_entity* entities, int capacity)
+{
+	const std::vector<AgentEntity>& all = world->obs.entities;
+	int n = int(all.size());
+	for (int k = 0; k < n && k < capacity; k++)
+	{
+		entities[k].image_id = all[k].imageID;
+		entities[k].x = all[k].x;
+		entities[k].y = all[k].y;
+	}
+	return n;
+}
+
+size_t si_grid_size(void)
+{
+	return GRID_SIZE;
+}
+
+void si_get_grid(const si_world* world, unsigned char* grid)
+{
+	world->env.observeGrid(grid);
+}
+
+size_t si_snapshot(const si_world* world, void* buffer, size_t capacity)
+{
+	return world->env.saveSnapshot(buffer, capacity);
+}
+
+int si_restore(si_world* world, const void* buffer, size_t size)
+{
+	if (!world->env.restoreSnapshot(buffer, size))
+		return 0;
+	world->env.observe(world->obs);
+	return 1;
+}
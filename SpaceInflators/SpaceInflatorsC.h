@@ -0,0 +1,107 @@
+#ifndef _SPACEINFLATORSC_H_
+#define _SPACEINFLATORSC_H_
+
+// Plain C interface to the game simulation, for driving it in-process from
+// other languages.  A world is an opaque handle; every buffer is owned by
+// the caller.  Worlds are independent of each other but a single world must
+// not be used from two threads at once.  Nothing here opens a window or
+// plays sound.
+//
+// Build the game sources other than main.cpp as a shared library with
+// SI_BUILD_DLL defined; on Windows, define SI_USE_DLL when including this
+// header from a program that links against that DLL.
+
+#include <stddef.h>
+
+#if defined(_WIN32)
+  #if defined(SI_BUILD_DLL)
+    #define SI_API __declspec(dllexport)
+  #elif defined(SI_USE_DLL)
+    #define SI_API __declspec(dllimport)
+  #else
+    #define SI_API
+  #endif
+#elif defined(__GNUC__)
+  #define SI_API __attribute__((visibility("default")))
+#else
+  #define SI_API
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define SI_ABI_VERSION 1
+
+typedef struct si_world si_world;
+
+// Actions: at most one move ORed with at most one shot
+#define SI_ACTION_NONE     0
+#define SI_ACTION_LEFT     1
+#define SI_ACTION_RIGHT    2
+#define SI_ACTION_UP       3
+#define SI_ACTION_DOWN     4
+#define SI_ACTION_FIRE     8
+#define SI_ACTION_TORPEDO  16
+
+// Flags returned by si_step
+#define SI_STEP_LIFE_LOST  1
+#define SI_STEP_DONE       2
+
+typedef struct si_state
+{
+	int player_x;
+	int player_y;
+	int player_energy;      // percent of full
+	int torpedoes;
+	int lives;
+	int round;
+	unsigned int score;
+	int num_entities;       // actors other than the player
+} si_state;
+
+typedef struct si_entity
+{
+	int image_id;           // one of the IID_ constants in GameConstants.h
+	int x;
+	int y;
+} si_entity;
+
+SI_API int si_abi_version(void);
+
+SI_API si_world* si_create(void);    // NULL if out of memory
+SI_API void si_destroy(si_world* world);
+
+  // Start a new game whose random events all follow from seed
+SI_API void si_reset(si_world* world, unsigned int seed);
+
+  // Play one tick.  Returns SI_STEP_ flags and sets *reward (if not NULL)
+  // to the score gained.  Once SI_STEP_DONE is returned, steps do nothing
+  // until the next si_reset or si_restore.
+SI_API int si_step(si_world* world, int action, int* reward);
+
+SI_API void si_get_state(const si_world* world, si_state* state);
+
+  // Copy up to capacity entities into entities; returns how many there are
+SI_API int si_get_entities(const si_world* world, si_entity* entities, int capacity);
+
+  // The grid observation: si_grid_size() bytes, laid out as
+  // grid[(channel * 40 + y) * 30 + x] with the channels of AgentEnv.h
+SI_API size_t si_grid_size(void);
+SI_API void si_get_grid(const si_world* world, unsigned char* grid);
+
+  // Write a snapshot of the game into buffer and return its size; the
+  // buffer holds it only if that size is <= capacity.  Pass a NULL buffer
+  // to learn the size.  Snapshots only load on the architecture and
+  // SI_ABI_VERSION that wrote them.
+SI_API size_t si_snapshot(const si_world* world, void* buffer, size_t capacity);
+
+  // Continue from a snapshot.  Returns 1 on success; on bad data returns 0
+  // and the world keeps the game it had.
+SI_API int si_restore(si_world* world, const void* buffer, size_t size);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // _SPACEINFLATORSC_H_
@@ -0,0 +1,289 @@
+#include "SpectatorSocket.h"
+#include <iostream>
+#include <cstring>
+#ifndef _WIN32
+#include <csignal>
+#include <cerrno>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#endif
+using namespace std;
+
+#ifdef _WIN32
+
+SpectatorServer::SpectatorServer()
+ : m_listenFd(-1), m_bytesSent(0), m_disconnected(0)
+{
+}
+
+SpectatorServer::~SpectatorServer()
+{
+}
+
+bool SpectatorServer::open(const string& path)
+{
+	cerr << "Spectator sockets need Unix domain sockets" << endl;
+	return false;
+}
+
+int SpectatorServer::acceptSpectators()
+{
+	return 0;
+}
+
+void SpectatorServer::publish(const vector<unsigned char>& frame, bool keyframe)
+{
+}
+
+bool SpectatorServer::flush(Spectator& s)
+{
+	return false;
+}
+
+SpectatorClient::SpectatorClient()
+ : m_fd(-1)
+{
+}
+
+SpectatorClient::~SpectatorClient()
+{
+}
+
+bool SpectatorClient::connect(const string& path)
+{
+	cerr << "Spectator sockets need Unix domain sockets" << endl;
+	return false;
+}
+
+bool SpectatorClient::receive(vector<unsigned char>& frame)
+{
+	return false;
+}
+
+bool SpectatorClient::readBytes(void* buffer, size_t n)
+{
+	return false;
+}
+
+#else
+
+namespace
+{
+	#ifndef MSG_NOSIGNAL
+	const int MSG_NOSIGNAL = 0;   // SIGPIPE is ignored instead
+	#endif
+
+	  // Fill in a socket address for path; false if the path is too long
+	bool makeAddress(const string& path, sockaddr_un& address)
+	{
+		memset(&address, 0, sizeof(address));
+		address.sun_family = AF_UNIX;
+		if (path.size() >= sizeof(address.sun_path))
+		{
+			cerr << "Socket path too long: " << path << endl;
+			return false;
+		}
+		strcpy(address.sun_path, path.c_str());
+		return true;
+	}
+}
+
+// SpectatorServer
+
+SpectatorServer::SpectatorServer()
+ : m_listenFd(-1), m_bytesSent(0), m_disconnected(0)
+{
+}
+
+SpectatorServer::~SpectatorServer()
+{
+	for (size_t k = 0; k < m_spectators.size(); k++)
+		close(m_spectators[k].fd);
+	if (m_listenFd >= 0)
+	{
+		close(m_listenFd);
+		unlink(m_path.c_str());
+	}
+}
+
+bool SpectatorServer::open(const string& path)
+{
+	sockaddr_un address;
+	if (m_listenFd >= 0 || !makeAddress(path, address))
+		return false;
+	  // A spectator that goes away must not take the game down with it
+	signal(SIGPIPE, SIG_IGN);
+	unlink(path.c_str());
+	m_listenFd = socket(AF_UNIX, SOCK_STREAM, 0);
+	if (m_listenFd < 0 ||
+	    bind(m_listenFd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0 ||
+	    listen(m_listenFd, 16) != 0 ||
+	    fcntl(m_listenFd, F_SETFL, O_NONBLOCK) != 0)
+	{
+		cerr << "Cannot listen at " << path << ": " << strerror(errno) << endl;
+		if (m_listenFd >= 0)
+			close(m_listenFd);
+		m_listenFd = -1;
+		return false;
+	}
+	m_path = path;
+	return true;
+}
+
+int SpectatorServer::acceptSpectators()
+{
+	int accepted = 0;
+	if (m_listenFd < 0)
+		return 0;
+	for (;;)
+	{
+		int fd = accept(m_listenFd, NULL, NULL);
+		if (fd < 0)
+			break;
+		fcntl(fd, F_SETFL, O_NONBLOCK);
+		Spectator s;
+		s.fd = fd;
+		s.synced = false;
+		s.sent = 0;
+		m_spectators.push_back(s);
+		accepted++;
+	}
+	return accepted;
+}
+
+void SpectatorServer::publish(const vector<unsigned char>& frame, bool keyframe)
+{
+	unsigned char prefix[10];
+	size_t prefixSize = 0;
+	for (size_t n = frame.size(); ; n >>= 7)
+	{
+		prefix[prefixSize++] = (unsigned char)(n >= 0x80 ? (n & 0x7f) | 0x80 : n);
+		if (n < 0x80)
+			break;
+	}
+
+	size_t kept = 0;
+	for (size_t k = 0; k < m_spectators.size(); k++)
+	{
+		Spectator& s = m_spectators[k];
+		s.synced = s.synced || keyframe;
+		if (s.synced)
+		{
+			s.pending.insert(s.pending.end(), prefix, prefix + prefixSize);
+			s.pending.insert(s.pending.end(), frame.begin(), frame.end());
+		}
+		if (s.pending.size() - s.sent > MAX_PENDING || !flush(s))
+		{
+			close(s.fd);
+			m_disconnected++;
+			continue;
+		}
+		if (kept != k)
+		{
+			m_spectators[kept].fd = s.fd;
+			m_spectators[kept].synced = s.synced;
+			m_spectators[kept].pending.swap(s.pending);
+			m_spectators[kept].sent = s.sent;
+		}
+		kept++;
+	}
+	m_spectators.resize(kept);
+}
+
+// Send as much of s's queue as the socket will take now.  Sent bytes stay
+// at the front of the queue until they are half of it, so a spectator that
+// is far behind doesn't cost a move of its whole backlog every frame.
+bool SpectatorServer::flush(Spectator& s)
+{
+	while (s.sent < s.pending.size())
+	{
+		ssize_t n = send(s.fd, &s.pending[s.sent], s.pending.size() - s.sent, MSG_NOSIGNAL);
+		if (n < 0)
+		{
+			if (errno == EAGAIN || errno == EWOULDBLOCK)
+				break;
+			if (errno == EINTR)
+				continue;
+			return false;
+		}
+		s.sent += n;
+		m_bytesSent += n;
+	}
+	if (s.sent == s.pending.size())
+	{
+		s.pending.clear();
+		s.sent = 0;
+	}
+	else if (s.sent > s.pending.size() / 2)
+	{
+		s.pending.erase(s.pending.begin(), s.pending.begin() + s.sent);
+		s.sent = 0;
+	}
+	return true;
+}
+
+// SpectatorClient
+
+SpectatorClient::SpectatorClient()
+ : m_fd(-1)
+{
+}
+
+SpectatorClient::~SpectatorClient()
+{
+	if (m_fd >= 0)
+		close(m_fd);
+}
+
+bool SpectatorClient::connect(const string& path)
+{
+	sockaddr_un address;
+	if (m_fd >= 0 || !makeAddress(path, address))
+		return false;
+	m_fd = socket(AF_UNIX, SOCK_STREAM, 0);
+	if (m_fd < 0 || ::connect(m_fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0)
+	{
+		cerr << "Cannot connect to " << path << ": " << strerror(errno) << endl;
+		if (m_fd >= 0)
+			close(m_fd);
+		m_fd = -1;
+		return false;
+	}
+	return true;
+}
+
+bool SpectatorClient::receive(vector<unsigned char>& frame)
+{
+	size_t size = 0;
+	for (int shift = 0; ; shift += 7)
+	{
+		unsigned char b;
+		if (shift > 28 || !readBytes(&b, 1))
+			return false;
+		size |= size_t(b & 0x7f) << shift;
+		if (!(b & 0x80))
+			break;
+	}
+	frame.resize(size);
+	return size == 0 || readBytes(&frame[0], size);
+}
+
+bool SpectatorClient::readBytes(void* buffer, size_t n)
+{
+	char* p = static_cast<char*>(buffer);
+	while (n > 0)
+	{
+		ssize_t got = recv(m_fd, p, n, 0);
+		if (got < 0 && errno == EINTR)
+			continue;
+		if (got <= 0)
+			return false;
+		p += got;
+		n -= got;
+	}
+	return true;
+}
+
+#endif // _WIN32
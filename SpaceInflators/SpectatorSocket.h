@@ -0,0 +1,93 @@
+#ifndef _SPECTATORSOCKET_H_
+#define _SPECTATORSOCKET_H_
+
+#include <string>
+#include <vector>
+#include <cstddef>
+
+// Frames from a StateEncoder, sent to spectators over a Unix domain stream
+// socket.  Each frame goes out as a varint byte count and then the frame.
+// Not available on Windows, where open() and connect() just fail.
+
+// The publishing side.  Never blocks: new spectators are accepted and
+// frames sent without waiting, and a spectator that falls more than
+// MAX_PENDING bytes behind is disconnected.
+class SpectatorServer
+{
+  public:
+	enum { MAX_PENDING = 1 << 20 };
+
+	SpectatorServer();
+	~SpectatorServer();
+
+	  // Listen at path, replacing any socket file already there; false with
+	  // a message on cerr if that fails
+	bool open(const std::string& path);
+
+	  // Take any spectators waiting to connect; returns how many.  They are
+	  // sent nothing until the next keyframe, so the caller will usually
+	  // want to ask its encoder for one.
+	int acceptSpectators();
+
+	  // Queue a frame to every spectator and send what the sockets will take
+	void publish(const std::vector<unsigned char>& frame, bool keyframe);
+
+	int getNumSpectators() const
+	{
+		return int(m_spectators.size());
+	}
+
+	  // Bytes handed to the sockets, length prefixes included
+	unsigned long long getBytesSent() const
+	{
+		return m_bytesSent;
+	}
+
+	int getNumDisconnected() const   // spectators that left or fell behind
+	{
+		return m_disconnected;
+	}
+
+  private:
+	SpectatorServer(const SpectatorServer&);
+	SpectatorServer& operator=(const SpectatorServer&);
+
+	struct Spectator
+	{
+		int fd;
+		bool synced;                          // has been sent a keyframe
+		std::vector<unsigned char> pending;   // queued to send
+		size_t sent;                          // bytes at the front of pending already sent
+	};
+
+	bool flush(Spectator& s);   // false if the spectator is gone
+
+	int                    m_listenFd;
+	std::string            m_path;
+	std::vector<Spectator> m_spectators;
+	unsigned long long     m_bytesSent;
+	int                    m_disconnected;
+};
+
+// The watching side: reads frames one at a time, blocking until each arrives
+class SpectatorClient
+{
+  public:
+	SpectatorClient();
+	~SpectatorClient();
+
+	bool connect(const std::string& path);   // false with a message on cerr
+
+	  // The next frame, or false when the server has gone away
+	bool receive(std::vector<unsigned char>& frame);
+
+  private:
+	SpectatorClient(const SpectatorClient&);
+	SpectatorClient& operator=(const SpectatorClient&);
+
+	bool readBytes(void* buffer, size_t n);
+
+	int m_fd;
+};
+
+#endif // _SPECTATORSOCKET_H_
@@ -0,0 +1,69 @@
+#ifndef _SPSCRING_H_
+#define _SPSCRING_H_
+
+#include <atomic>
+
+// Bounded lock-free ring for exactly one producer thread and one consumer
+// thread.  push() and pop() never block; push() fails when the ring is full
+// and the caller decides what to do with the item.  CAPACITY must be a
+// power of two.
+template <typename T, unsigned int CAPACITY>
+class SpscRing
+{
+  public:
+	SpscRing()
+	 : m_head(0), m_tail(0)
+	{
+	}
+
+	  // Producer side
+	bool push(const T& item)
+	{
+		unsigned int tail = m_tail.load(std::memory_order_relaxed);
+		if (tail - m_head.load(std::memory_order_acquire) == CAPACITY)
+			return false;
+		m_items[tail & (CAPACITY-1)] = item;
+		m_tail.store(tail + 1, std::memory_order_release);
+		return true;
+	}
+
+	  // Consumer side
+	bool peek(T& item) const
+	{
+		unsigned int head = m_head.load(std::memory_order_relaxed);
+		if (head == m_tail.load(std::memory_order_acquire))
+			return false;
+		item = m_items[head & (CAPACITY-1)];
+		return true;
+	}
+
+	bool pop(T& item)
+	{
+		if (!peek(item))
+			return false;
+		m_head.store(m_head.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+		return true;
+	}
+
+	  // Either side; exact only when called from the consumer
+	unsigned int size() const
+	{
+		unsigned int head = m_head.load(std::memory_order_acquire);
+		return m_tail.load(std::memory_order_acquire) - head;
+	}
+
+	unsigned int capacity() const
+	{
+		return CAPACITY;
+	}
+
+  private:
+	SpscRing(const SpscRing&);
+	SpscRing& operator=(const SpscRing&);
+
+	T                         m_items[CAPACITY];
+	std::atomic<unsigned int> m_head;   // next slot to read
+	std::atomic<unsigned int> m_tail;   // next slot to write
+};
+
+#endif // _SPSCRING_H_
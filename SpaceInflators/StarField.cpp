@@ -0,0 +1,88 @@
+#include "StarField.h"
+#include "GameConstants.h"
+#include "Snapshot.h"
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define STARFIELD_SSE2
+#include <emmintrin.h>
+#endif
+
+StarField::StarField()
+{
+	clear();
+}
+
+void StarField::clear()
+{
+	m_count = 0;
+	  // Slots past m_count are scrolled too (in whole SIMD lanes), so keep them defined
+	for (int i = 0; i < CAPACITY; i++)
+		m_x[i] = m_y[i] = m_prevY[i] = 0;
+}
+
+void StarField::spawn(int x)
+{
+	if (m_count == CAPACITY)
+		return;
+	m_x[m_count] = x;
+	m_y[m_count] = VIEW_HEIGHT-1;
+	m_prevY[m_count] = VIEW_HEIGHT-1;
+	m_count++;
+}
+
+void StarField::scroll()
+{
+	int i = 0;
+#ifdef STARFIELD_SSE2
+	const __m128i one = _mm_set1_epi32(1);
+	for ( ; i < m_count; i += 4)
+	{
+		__m128i y = _mm_loadu_si128(reinterpret_cast<const __m128i*>(m_y + i));
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(m_prevY + i), y);
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(m_y + i), _mm_sub_epi32(y, one));
+	}
+#else
+	for ( ; i < m_count; i++)
+	{
+		m_prevY[i] = m_y[i];
+		m_y[i]--;
+	}
+#endif
+
+	  // Oldest stars are first, so the ones that left the board are a prefix
+	int gone = 0;
+	while (gone < m_count && m_y[gone] < 0)
+		gone++;
+	if (gone > 0)
+	{
+		m_count -= gone;
+		memmove(m_x, m_x + gone, m_count * sizeof(int));
+		memmove(m_y, m_y + gone, m_count * sizeof(int));
+		memmove(m_prevY, m_prevY + gone, m_count * sizeof(int));
+	}
+}
+
+void StarField::saveState(SnapshotWriter& w) const
+{
+	w.putInt(m_count);
+	for (int i = 0; i < m_count; i++)
+	{
+		w.putInt(m_x[i]);
+		w.putInt(m_y[i]);
+		w.putInt(m_prevY[i]);
+	}
+}
+
+void StarField::loadState(SnapshotReader& r)
+{
+	clear();
+	int count = r.getCount(CAPACITY);
+	for (int i = 0; i < count; i++)
+	{
+		m_x[i] = r.getInt();
+		m_y[i] = r.getInt();
+		m_prevY[i] = r.getInt();
+	}
+	m_count = count;
+}
@@ -0,0 +1,54 @@
+#ifndef _STARFIELD_H_
+#define _STARFIELD_H_
+
+// The scrolling background stars.  Stars are not actors: they never
+// collide or interact, so they live in a fixed-capacity structure-of-arrays
+// buffer that scrolls every star down one row per tick in a single pass.
+// Because every star moves at the same speed, the buffer stays ordered
+// oldest first and culling only ever trims a prefix.
+class SnapshotWriter;
+class SnapshotReader;
+
+class StarField
+{
+  public:
+	static const int CAPACITY = 64;   // stars live VIEW_HEIGHT ticks; about 1 in 3 ticks spawns one
+
+	StarField();
+
+	void spawn(int x);   // add a star at column x on the top row; dropped if the buffer is full
+	void scroll();       // move every star down a row and cull those off the board
+	void clear();
+	void saveState(SnapshotWriter& w) const;
+	void loadState(SnapshotReader& r);
+
+	int size() const
+	{
+		return m_count;
+	}
+
+	int getX(int i) const
+	{
+		return m_x[i];
+	}
+
+	int getY(int i) const
+	{
+		return m_y[i];
+	}
+
+	  // Row the star occupied before the last scroll (its spawn row if it
+	  // spawned since), for drawing it part way through the tick
+	int getPrevY(int i) const
+	{
+		return m_prevY[i];
+	}
+
+  private:
+	int m_count;
+	int m_x[CAPACITY];
+	int m_y[CAPACITY];
+	int m_prevY[CAPACITY];
+};
+
+#endif // _STARFIELD_H_
@@ -0,0 +1,395 @@
+#include "StateStream.h"
+#include "StudentWorld.h"
+#include <algorithm>
+using namespace std;
+
+namespace
+{
+	enum { FIELD_SCORE = 1, FIELD_LIVES = 2, FIELD_ROUND = 4, FIELD_TORPEDOES = 8, ALL_FIELDS = 15 };
+
+	void putVarint(vector<unsigned char>& out, unsigned long long v)
+	{
+		while (v >= 0x80)
+		{
+			out.push_back((unsigned char)(v | 0x80));
+			v >>= 7;
+		}
+		out.push_back((unsigned char)v);
+	}
+
+	  // Zigzag coding keeps small negative numbers small
+	void putSigned(vector<unsigned char>& out, long long v)
+	{
+		putVarint(out, ((unsigned long long)v << 1) ^ (unsigned long long)(v >> 63));
+	}
+
+	void putEntity(vector<unsigned char>& out, const EntityState& e, unsigned int& lastSerial)
+	{
+		putVarint(out, e.serial - lastSerial);
+		lastSerial = e.serial;
+		putVarint(out, e.imageID);
+		putSigned(out, e.x);
+		putSigned(out, e.y);
+		putSigned(out, e.energy);
+	}
+
+	  // Reads varints from a frame, returning zeros once it runs past the
+	  // end or meets a varint too long to be one we wrote
+	class FrameReader
+	{
+	  public:
+		FrameReader(const unsigned char* data, size_t size)
+		 : m_pos(data), m_end(data + size), m_ok(true)
+		{
+		}
+
+		unsigned long long getVarint()
+		{
+			unsigned long long v = 0;
+			for (int shift = 0; shift < 64; shift += 7)
+			{
+				if (m_pos == m_end)
+					break;
+				unsigned char b = *m_pos++;
+				v |= (unsigned long long)(b & 0x7f) << shift;
+				if (!(b & 0x80))
+					return v;
+			}
+			m_ok = false;
+			return 0;
+		}
+
+		long long getSigned()
+		{
+			unsigned long long v = getVarint();
+			return (long long)(v >> 1) ^ -(long long)(v & 1);
+		}
+
+		  // A count of items each at least minBytes long; more than the rest
+		  // of the frame could hold is an error
+		size_t getCount(size_t minBytes)
+		{
+			unsigned long long n = getVarint();
+			if (n > (unsigned long long)(m_end - m_pos) / minBytes)
+			{
+				m_ok = false;
+				return 0;
+			}
+			return size_t(n);
+		}
+
+		  // An entity as putEntity wrote it; serials after the first in a
+		  // list must go up
+		bool getEntity(EntityState& e, unsigned int& lastSerial, bool first)
+		{
+			unsigned int step = (unsigned int)getVarint();
+			e.serial = lastSerial + step;
+			e.imageID = int(getVarint());
+			e.x = int(getSigned());
+			e.y = int(getSigned());
+			e.energy = int(getSigned());
+			lastSerial = e.serial;
+			return m_ok && (first || step > 0);
+		}
+
+		bool ok() const
+		{
+			return m_ok;
+		}
+
+		bool atEnd() const
+		{
+			return m_pos == m_end;
+		}
+
+	  private:
+		const unsigned char* m_pos;
+		const unsigned char* m_end;
+		bool m_ok;
+	};
+
+	bool bySerial(const EntityState& a, const EntityState& b)
+	{
+		return a.serial < b.serial;
+	}
+}
+
+// StateEncoder
+
+StateEncoder::StateEncoder(int keyframeInterval)
+ : m_keyframeInterval(keyframeInterval > 0 ? keyframeInterval : 1), m_sinceKeyframe(0),
+   m_forceKeyframe(true), m_lastWasKeyframe(false)
+{
+	m_fields.tick = -1;
+	m_fields.score = 0;
+	m_fields.lives = m_fields.round = m_fields.torpedoes = 0;
+}
+
+void StateEncoder::requestKeyframe()
+{
+	m_forceKeyframe = true;
+}
+
+// Every entity in the world, sorted by serial, and the status fields
+void StateEncoder::capture(const StudentWorld& world, vector<EntityState>& entities, StreamFields& fields)
+{
+	entities.clear();
+	fields.tick = world.getTick();
+	fields.score = world.getScore();
+	fields.lives = world.getLives();
+	fields.round = world.getRound();
+	fields.torpedoes = 0;
+
+	const Player* player = world.getPlayer();
+	if (player != NULL)
+	{
+		EntityState e = { player->getSerial(), IID_PLAYER_SHIP, player->getX(), player->getY(), player->getEnergy() };
+		entities.push_back(e);
+		fields.torpedoes = player->getNumTorpedoes();
+	}
+	const Player* second = world.getSecondPlayer();
+	if (second != NULL)
+	{
+		EntityState e = { second->getSerial(), IID_PLAYER_SHIP, second->getX(), second->getY(), second->getEnergy() };
+		entities.push_back(e);
+	}
+	const vector<Actor*>& actors = world.getActors();
+	for (size_t k = 0; k < actors.size(); k++)
+	{
+		const Actor* a = actors[k];
+		int id = a->getID();
+		EntityState e = { a->getSerial(), id, a->getX(), a->getY(), 0 };
+		if (id == IID_NACHLING || id == IID_WEALTHY_NACHLING || id == IID_SMALLBOT)
+			e.energy = static_cast<const Ship*>(a)->getEnergy();
+		entities.push_back(e);
+	}
+	  // Actors are kept in the order they were made, so this is nearly
+	  // sorted already; only the players, remade each life, are out of place
+	sort(entities.begin(), entities.end(), bySerial);
+}
+
+void StateEncoder::encode(const StudentWorld& world, vector<unsigned char>& frame)
+{
+	StreamFields fields;
+	capture(world, m_current, fields);
+	bool keyframe = m_forceKeyframe || m_sinceKeyframe + 1 >= m_keyframeInterval ||
+	                fields.tick <= m_fields.tick;
+
+	frame.clear();
+	putVarint(frame, keyframe ? FRAME_KEYFRAME : FRAME_DELTA);
+	putVarint(frame, fields.tick);
+	int mask = ALL_FIELDS;
+	if (!keyframe)
+		mask = (fields.score != m_fields.score ? FIELD_SCORE : 0) |
+		       (fields.lives != m_fields.lives ? FIELD_LIVES : 0) |
+		       (fields.round != m_fields.round ? FIELD_ROUND : 0) |
+		       (fields.torpedoes != m_fields.torpedoes ? FIELD_TORPEDOES : 0);
+	putVarint(frame, mask);
+	if (mask & FIELD_SCORE)
+		putVarint(frame, fields.score);
+	if (mask & FIELD_LIVES)
+		putVarint(frame, fields.lives);
+	if (mask & FIELD_ROUND)
+		putVarint(frame, fields.round);
+	if (mask & FIELD_TORPEDOES)
+		putVarint(frame, fields.torpedoes);
+
+	unsigned int lastSerial = 0;
+	if (keyframe)
+	{
+		putVarint(frame, m_current.size());
+		for (size_t k = 0; k < m_current.size(); k++)
+			putEntity(frame, m_current[k], lastSerial);
+	}
+	else
+	{
+		  // Walk the old and new lists together; both are sorted by serial.
+		  // m_moved holds pairs: new index, then old index.
+		m_died.clear();
+		m_spawned.clear();
+		m_moved.clear();
+		m_energy.clear();
+		size_t i = 0, j = 0;
+		while (i < m_entities.size() || j < m_current.size())
+		{
+			if (j == m_current.size() || (i < m_entities.size() && m_entities[i].serial < m_current[j].serial))
+				m_died.push_back(int(i++));
+			else if (i == m_entities.size() || m_current[j].serial < m_entities[i].serial)
+				m_spawned.push_back(int(j++));
+			else
+			{
+				if (m_current[j].x != m_entities[i].x || m_current[j].y != m_entities[i].y)
+				{
+					m_moved.push_back(int(j));
+					m_moved.push_back(int(i));
+				}
+				if (m_current[j].energy != m_entities[i].energy)
+					m_energy.push_back(int(j));
+				i++;
+				j++;
+			}
+		}
+
+		putVarint(frame, m_died.size());
+		for (size_t k = 0; k < m_died.size(); k++)
+		{
+			putVarint(frame, m_entities[m_died[k]].serial - lastSerial);
+			lastSerial = m_entities[m_died[k]].serial;
+		}
+		lastSerial = 0;
+		putVarint(frame, m_spawned.size());
+		for (size_t k = 0; k < m_spawned.size(); k++)
+			putEntity(frame, m_current[m_spawned[k]], lastSerial);
+		lastSerial = 0;
+		putVarint(frame, m_moved.size() / 2);
+		for (size_t k = 0; k < m_moved.size(); k += 2)
+		{
+			const EntityState& now = m_current[m_moved[k]];
+			const EntityState& before = m_entities[m_moved[k + 1]];
+			putVarint(frame, now.serial - lastSerial);
+			lastSerial = now.serial;
+			putSigned(frame, now.x - before.x);
+			putSigned(frame, now.y - before.y);
+		}
+		lastSerial = 0;
+		putVarint(frame, m_energy.size());
+		for (size_t k = 0; k < m_energy.size(); k++)
+		{
+			const EntityState& now = m_current[m_energy[k]];
+			putVarint(frame, now.serial - lastSerial);
+			lastSerial = now.serial;
+			putSigned(frame, now.energy);
+		}
+	}
+
+	m_entities.swap(m_current);
+	m_fields = fields;
+	m_sinceKeyframe = keyframe ? 0 : m_sinceKeyframe + 1;
+	m_forceKeyframe = false;
+	m_lastWasKeyframe = keyframe;
+}
+
+// StateDecoder
+
+StateDecoder::StateDecoder()
+ : m_hasKeyframe(false)
+{
+	m_fields.tick = 0;
+	m_fields.score = 0;
+	m_fields.lives = m_fields.round = m_fields.torpedoes = 0;
+}
+
+bool StateDecoder::apply(const unsigned char* frame, size_t size)
+{
+	FrameReader r(frame, size);
+	int kind = int(r.getVarint());
+	if (kind != StateEncoder::FRAME_KEYFRAME && (kind != StateEncoder::FRAME_DELTA || !m_hasKeyframe))
+		return false;
+	StreamFields fields = m_fields;
+	fields.tick = (long long)r.getVarint();
+	int mask = int(r.getVarint());
+	if (mask & FIELD_SCORE)
+		fields.score = (unsigned int)r.getVarint();
+	if (mask & FIELD_LIVES)
+		fields.lives = int(r.getVarint());
+	if (mask & FIELD_ROUND)
+		fields.round = int(r.getVarint());
+	if (mask & FIELD_TORPEDOES)
+		fields.torpedoes = int(r.getVarint());
+
+	m_next.clear();
+	unsigned int lastSerial = 0;
+	if (kind == StateEncoder::FRAME_KEYFRAME)
+	{
+		size_t n = r.getCount(5);
+		for (size_t k = 0; k < n; k++)
+		{
+			EntityState e;
+			if (!r.getEntity(e, lastSerial, k == 0))
+				return false;
+			m_next.push_back(e);
+		}
+	}
+	else
+	{
+		m_died.clear();
+		m_spawned.clear();
+		m_moved.clear();
+		m_energy.clear();
+		size_t n = r.getCount(1);
+		for (size_t k = 0; k < n; k++)
+		{
+			lastSerial += (unsigned int)r.getVarint();
+			m_died.push_back(lastSerial);
+		}
+		lastSerial = 0;
+		n = r.getCount(5);
+		for (size_t k = 0; k < n; k++)
+		{
+			EntityState e;
+			if (!r.getEntity(e, lastSerial, k == 0))
+				return false;
+			m_spawned.push_back(e);
+		}
+		lastSerial = 0;
+		n = r.getCount(3);
+		for (size_t k = 0; k < n; k++)
+		{
+			EntityState e = { 0, 0, 0, 0, 0 };
+			lastSerial += (unsigned int)r.getVarint();
+			e.serial = lastSerial;
+			e.x = int(r.getSigned());
+			e.y = int(r.getSigned());
+			m_moved.push_back(e);
+		}
+		lastSerial = 0;
+		n = r.getCount(2);
+		for (size_t k = 0; k < n; k++)
+		{
+			EntityState e = { 0, 0, 0, 0, 0 };
+			lastSerial += (unsigned int)r.getVarint();
+			e.serial = lastSerial;
+			e.energy = int(r.getSigned());
+			m_energy.push_back(e);
+		}
+		if (!r.ok())
+			return false;
+
+		  // Every list is sorted by serial, so one pass over the old state
+		  // applies them all; anything left over names an unknown entity
+		size_t d = 0, s = 0, m = 0, en = 0;
+		for (size_t k = 0; k < m_entities.size(); k++)
+		{
+			EntityState e = m_entities[k];
+			for (; s < m_spawned.size() && m_spawned[s].serial < e.serial; s++)
+				m_next.push_back(m_spawned[s]);
+			if (s < m_spawned.size() && m_spawned[s].serial == e.serial)
+				return false;
+			if (d < m_died.size() && m_died[d] == e.serial)
+			{
+				d++;
+				continue;
+			}
+			if (m < m_moved.size() && m_moved[m].serial == e.serial)
+			{
+				e.x += m_moved[m].x;
+				e.y += m_moved[m].y;
+				m++;
+			}
+			if (en < m_energy.size() && m_energy[en].serial == e.serial)
+				e.energy = m_energy[en++].energy;
+			m_next.push_back(e);
+		}
+		for (; s < m_spawned.size(); s++)
+			m_next.push_back(m_spawned[s]);
+		if (d != m_died.size() || m != m_moved.size() || en != m_energy.size())
+			return false;
+	}
+	if (!r.ok() || !r.atEnd())
+		return false;
+
+	m_entities.swap(m_next);
+	m_fields = fields;
+	m_hasKeyframe = true;
+	return true;
+}
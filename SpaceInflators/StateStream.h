@@ -0,0 +1,129 @@
+#ifndef _STATESTREAM_H_
+#define _STATESTREAM_H_
+
+#include <vector>
+#include <cstddef>
+
+class StudentWorld;
+
+// What a spectator sees of one actor (the player included)
+struct EntityState
+{
+	unsigned int serial;   // Actor::getSerial(), unique within a world
+	int imageID;
+	int x;
+	int y;
+	int energy;            // ships only; 0 for projectiles and goodies
+
+	bool operator==(const EntityState& other) const
+	{
+		return serial == other.serial && imageID == other.imageID && x == other.x &&
+		       y == other.y && energy == other.energy;
+	}
+};
+
+// The status line a spectator sees
+struct StreamFields
+{
+	long long    tick;
+	unsigned int score;
+	int          lives;
+	int          round;
+	int          torpedoes;       // the first player's
+};
+
+// Encodes a world into one frame per tick for spectators.  A keyframe
+// holds every entity; a delta holds only the entities that spawned, died,
+// moved or changed energy since the previous frame, and the status fields
+// that changed.  Numbers are varints, serials are sent as the difference
+// from the one before in the same list, and moves as signed steps, so a
+// quiet tick costs a few bytes.
+//
+// Frame layout (all numbers varints, signed ones zigzag coded):
+//   kind (FRAME_KEYFRAME or FRAME_DELTA), tick,
+//   field mask, then score, lives, round, torpedoes for each bit set
+//   keyframe: count, then per entity: serial step, image ID, x, y, energy
+//   delta:    died count, serial steps;
+//             spawned count, entities as in a keyframe;
+//             moved count, per entity: serial step, dx, dy;
+//             energy count, per entity: serial step, energy
+class StateEncoder
+{
+  public:
+	enum { FRAME_KEYFRAME = 1, FRAME_DELTA = 2 };
+
+	  // A keyframe every keyframeInterval frames, so a spectator that
+	  // missed one catches up; 1 sends nothing but keyframes
+	StateEncoder(int keyframeInterval);
+
+	  // Replace frame with the encoding of world's state now.  A world whose
+	  // tick has not advanced since the last frame is taken to be a new one
+	  // and gets a keyframe.
+	void encode(const StudentWorld& world, std::vector<unsigned char>& frame);
+
+	void requestKeyframe();   // make the next frame a keyframe, for a new spectator
+
+	bool lastWasKeyframe() const
+	{
+		return m_lastWasKeyframe;
+	}
+
+	  // The state the last frame brought a spectator up to, sorted by serial
+	const std::vector<EntityState>& getEntities() const
+	{
+		return m_entities;
+	}
+
+	const StreamFields& getFields() const
+	{
+		return m_fields;
+	}
+
+  private:
+	static void capture(const StudentWorld& world, std::vector<EntityState>& entities, StreamFields& fields);
+
+	int                      m_keyframeInterval;
+	int                      m_sinceKeyframe;
+	bool                     m_forceKeyframe;
+	bool                     m_lastWasKeyframe;
+	std::vector<EntityState> m_entities;   // as of the last frame
+	StreamFields             m_fields;
+	std::vector<EntityState> m_current;    // scratch, swapped with m_entities
+	std::vector<int>         m_died, m_spawned, m_moved, m_energy;   // scratch indices
+};
+
+// Rebuilds the state a StateEncoder sent, one frame at a time
+class StateDecoder
+{
+  public:
+	StateDecoder();
+
+	  // Apply one frame; false, leaving the state as it was, if the frame is
+	  // malformed or is a delta with no keyframe before it
+	bool apply(const unsigned char* frame, size_t size);
+
+	bool hasKeyframe() const
+	{
+		return m_hasKeyframe;
+	}
+
+	const std::vector<EntityState>& getEntities() const
+	{
+		return m_entities;
+	}
+
+	const StreamFields& getFields() const
+	{
+		return m_fields;
+	}
+
+  private:
+	bool                     m_hasKeyframe;
+	std::vector<EntityState> m_entities;   // sorted by serial
+	StreamFields             m_fields;
+	std::vector<EntityState> m_next;       // scratch, swapped with m_entities
+	std::vector<unsigned int> m_died;      // scratch for a delta's lists
+	std::vector<EntityState> m_spawned, m_moved, m_energy;
+};
+
+#endif // _STATESTREAM_H_
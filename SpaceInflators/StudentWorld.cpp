@@ -1,4 +1,7 @@
 #include "StudentWorld.h"
+#include "Snapshot.h"
+#include "Metrics.h"
+#include "RoundParams.h"
 #include <algorithm>
 #include <string>
 #include <sstream>
@@ -15,6 +18,14 @@ GameWorld* createStudentWorld()
 // Constructor
 StudentWorld::StudentWorld()
 {
+	m_player = NULL; // No player until init
+	m_player2 = NULL;
+	m_twoPlayers = false;
+	m_liveActors = 0;
+	m_tick = 0;
+	m_nextSerial = 0;
+	m_dispatch = DISPATCH_VIRTUAL;
+	m_totalKills = 0;
 	m_round = 1;     // Start at round 1
 	m_numDead = 0;   // Start with 0 aliens killed
 }
@@ -23,6 +34,7 @@ StudentWorld::StudentWorld()
 StudentWorld::~StudentWorld()
 {
 	delete m_player;   // Delete the player
+	delete m_player2;
 	std::vector<Actor*>::iterator iter = m_actors.end();
 	// Delete all the actors in the vector
 	while (iter != m_actors.begin())
@@ -33,6 +45,7 @@ StudentWorld::~StudentWorld()
 	// Empty the vector
 	while (!m_actors.empty())
 		m_actors.pop_back();
+	ActorStats::retire(m_actorStats);   // Add this world's counts to the process totals
 }
 
 // Add a pointer to an actor to the vector
@@ -78,13 +91,13 @@ void StudentWorld::addAliensOrStars()
 			num++;
 	}
 	// If the number of aliens is smaller than the round limit and the number needed to move to next round
-	if (num < int(2+(.5*m_round)) && num < (4*getRound() - m_numDead))
+	if (num < roundParams(m_round).maxAliensOnScreen && num < (4*getRound() - m_numDead))
 	{
 		// 70% chance of adding a kind Nachling
-		if (rand() % 100 < 70)
+		if (randInt(100) < 70)
 		{
 			// 20% chance of adding a WealthyNachling
-			if (rand() % 100 < 20)
+			if (randInt(100) < 20)
 				new WealthyNachling(this, getRound());
 			// Otherwise add a regular Nachling
 			else
@@ -95,8 +108,147 @@ void StudentWorld::addAliensOrStars()
 			new Smallbot(this, getRound());
 	}
 	// One in three chance of adding a new Star
-	if (rand() % 100 < 33)
-		new Star(this);
+	if (randInt(100) < 33)
+		m_stars.spawn(randInt(VIEW_WIDTH));
+}
+
+// Get the background stars
+const StarField* StudentWorld::getStarField() const
+{
+	return &m_stars;
+}
+
+// Choose how move() calls the actors' doSomething
+void StudentWorld::setDispatchMode(DispatchMode mode)
+{
+	m_dispatch = mode;
+}
+
+// Make each living actor do something.  Actors added during the loop (new
+// projectiles) act in the same tick, after the ones that were there first.
+void StudentWorld::updateActors()
+{
+	if (m_dispatch == DISPATCH_VIRTUAL)
+	{
+		for (int k = 0; k < m_actors.size(); k++)
+		{
+			if (!(m_actors[k]->isDead()))
+				m_actors[k]->doSomething();
+		}
+		return;
+	}
+
+	int k = 0;
+	if (m_dispatch == DISPATCH_GROUPED)
+	{
+		  // Counting sort of the indices by image ID, stable within a type
+		int first[NUM_IMAGE_IDS + 1] = { 0 };
+		int numActors = m_actors.size();
+		for (int i = 0; i < numActors; i++)
+			first[m_actors[i]->getID() + 1]++;
+		for (int id = 0; id < NUM_IMAGE_IDS; id++)
+			first[id + 1] += first[id];
+		m_typeOrder.resize(numActors);
+		for (int i = 0; i < numActors; i++)
+			m_typeOrder[first[m_actors[i]->getID()]++] = i;
+		for (int i = 0; i < numActors; i++)
+		{
+			Actor* a = m_actors[m_typeOrder[i]];
+			if (!a->isDead())
+				doSomethingByType(a);
+		}
+		k = numActors;
+	}
+	for ( ; k < m_actors.size(); k++)
+	{
+		if (!(m_actors[k]->isDead()))
+			doSomethingByType(m_actors[k]);
+	}
+}
+
+// Ticks moved so far
+long long StudentWorld::getTick() const
+{
+	return m_tick;
+}
+
+// Hand out the next actor serial number
+unsigned int StudentWorld::nextActorSerial()
+{
+	return m_nextSerial++;
+}
+
+// This world's allocations and lifetimes by actor type
+const ActorStats* StudentWorld::getActorStats() const
+{
+	return &m_actorStats;
+}
+
+// Publish how many actors of each type are alive
+void StudentWorld::updateActorMetrics()
+{
+	MetricsShard* metrics = getMetrics();
+	if (metrics == NULL)
+		return;
+	int counts[NUM_IMAGE_IDS] = { 0 };
+	for (int k = 0; k < m_actors.size(); k++)
+		counts[m_actors[k]->getID()]++;
+	counts[IID_PLAYER_SHIP] = (m_player != NULL ? 1 : 0) + (m_player2 != NULL ? 1 : 0);
+	counts[IID_STAR] = m_stars.size();
+	for (int id = 0; id < NUM_IMAGE_IDS; id++)
+		metrics->setActors(id, counts[id]);
+}
+
+// Count a newly constructed actor
+void StudentWorld::actorCreated(int imageID)
+{
+	m_liveActors++;
+	m_actorStats.created(imageID);
+	metricsAdd(getMetrics(), METRIC_ACTORS_CREATED);
+}
+
+// Count a deleted actor
+void StudentWorld::actorDestroyed(int imageID, long long ageTicks)
+{
+	m_liveActors--;
+	m_actorStats.destroyed(imageID, ageTicks);
+	metricsAdd(getMetrics(), METRIC_ACTORS_DELETED);
+}
+
+// Get the debris particles
+const EffectPool* StudentWorld::getEffects() const
+{
+	return &m_effects;
+}
+
+// Throw debris out of the actor's cell
+void StudentWorld::addEffect(EffectPool::Burst kind, Actor* a)
+{
+	m_effects.burst(kind, a->getX(), a->getY());
+}
+
+// Get the player (NULL between cleanUp and init)
+const Player* StudentWorld::getPlayer() const
+{
+	return m_player;
+}
+
+// Get the second player's ship (NULL in a one-player game)
+const Player* StudentWorld::getSecondPlayer() const
+{
+	return m_player2;
+}
+
+// Choose whether the next init() makes a second player's ship
+void StudentWorld::setTwoPlayers(bool twoPlayers)
+{
+	m_twoPlayers = twoPlayers;
+}
+
+// Get every actor other than the player
+const std::vector<Actor*>& StudentWorld::getActors() const
+{
+	return m_actors;
 }
 
 // Get the player's current location
@@ -112,76 +264,249 @@ int StudentWorld::getRound() const
 	return m_round;
 }
 
-// Get a vector of aliens that have collided with specified actor
-std::vector<Alien*> StudentWorld::getCollidingAliens(Actor* a)
+// Increase the number of dead aliens by one
+void StudentWorld::increaseDead()
+{
+	m_numDead++;
+	m_totalKills++;
+}
+
+// Get the number of aliens killed in every round so far
+int StudentWorld::getTotalKills() const
 {
-	std::vector<Alien*> m_aliens;
+	return m_totalKills;
+}
+
+// Record where the player and every actor begin this tick
+void StudentWorld::markTickStart()
+{
+	m_player->markTickStart();
+	if (m_player2 != NULL)
+		m_player2->markTickStart();
 	for (int k = 0; k < m_actors.size(); k++)
+		m_actors[k]->markTickStart();
+}
+
+// Two actors collide if they end the tick in the same cell, or if they
+// swapped cells, passing through each other during the tick
+bool StudentWorld::collided(const Actor* a, const Actor* b)
+{
+	if (a->getX() == b->getX() && a->getY() == b->getY())
+		return true;
+	return a->getTickStartX() == b->getX() && a->getTickStartY() == b->getY() &&
+	       b->getTickStartX() == a->getX() && b->getTickStartY() == a->getY();
+}
+
+// Bucket the living aliens on the board by the cell they are in.  Each
+// cell's list is in update order, so hits are dealt in that order too.
+void StudentWorld::indexAliens()
+{
+	m_cellFirst.assign(VIEW_WIDTH * VIEW_HEIGHT, -1);
+	m_cellNext.resize(m_actors.size());
+	for (int k = m_actors.size() - 1; k >= 0; k--)
 	{
-		// Find all aliens in m_actors that have the same coordinates as actor
-		Alien *p = dynamic_cast<Alien*>(m_actors[k]);
-		if (p != NULL && !(p->isDead()) && m_actors[k]->getX() == a->getX() && m_actors[k]->getY() == a->getY())
-			// Push into the vector of collided aliens
-			m_aliens.push_back(p);
+		Actor* a = m_actors[k];
+		int id = a->getID();
+		if ((id != IID_NACHLING && id != IID_WEALTHY_NACHLING && id != IID_SMALLBOT) ||
+		    a->isDead() || !onBoard(a))
+			continue;
+		int cell = a->getY() * VIEW_WIDTH + a->getX();
+		m_cellNext[k] = m_cellFirst[cell];
+		m_cellFirst[cell] = k;
 	}
-	// Return this new vector
-	return m_aliens;
 }
 
-// Increase the number of dead aliens by one
-void StudentWorld::increaseDead()
+// Find the living aliens that met actor a this tick.  The only cells such
+// an alien can be in are the one a ended in and, for a swap, the one a
+// started in.
+void StudentWorld::getCollidingAliens(const Actor* a, std::vector<Alien*>& aliens, long long& checks) const
 {
-	m_numDead++;
+	aliens.clear();
+	int cells[2] = { -1, -1 };
+	if (onBoard(a))
+		cells[0] = a->getY() * VIEW_WIDTH + a->getX();
+	int startX = a->getTickStartX(), startY = a->getTickStartY();
+	if ((startX != a->getX() || startY != a->getY()) &&
+	    startX >= 0 && startX < VIEW_WIDTH && startY >= 0 && startY < VIEW_HEIGHT)
+		cells[1] = startY * VIEW_WIDTH + startX;
+	for (int c = 0; c < 2; c++)
+	{
+		if (cells[c] < 0)
+			continue;
+		for (int k = m_cellFirst[cells[c]]; k >= 0; k = m_cellNext[k])
+		{
+			checks++;
+			if (!(m_actors[k]->isDead()) && collided(a, m_actors[k]))
+				aliens.push_back(static_cast<Alien*>(m_actors[k]));
+		}
+	}
 }
 
-// Count the number of projectiles fired by aliens
-int StudentWorld::getNumAlienFiredProjectiles() const
+// Find every pair that met this tick, once everything has moved, and deal
+// with them in a fixed order: the player ramming aliens, the player's
+// projectiles hitting aliens, alien projectiles hitting the player, then
+// the player picking up goodies.  An actor killed by an earlier step takes
+// no part in a later one, and goodies dropped by aliens killed here are
+// not checked until the next tick.
+void StudentWorld::resolveCollisions()
 {
-	int num = 0;
+	indexAliens();
+	int numActors = m_actors.size();
+	long long checks = 0;
+	std::vector<Alien*> aliens;
+	Player* players[MAX_PLAYERS] = { m_player, m_player2 };
+
+	// Each alien a ship rammed is destroyed, and the ramming costs the
+	// ship 15 energy however many there were
+	for (int p = 0; p < MAX_PLAYERS; p++)
+	{
+		if (players[p] == NULL || players[p]->isDead())
+			continue;
+		getCollidingAliens(players[p], aliens, checks);
+		for (int k = 0; k < aliens.size(); k++)
+			aliens[k]->damage(aliens[k]->getEnergy(), false);
+		if (!aliens.empty())
+			players[p]->damage(15, false);
+	}
+
+	// A player's projectile damages every alien it met and is used up
+	for (int k = 0; k < numActors; k++)
+	{
+		int id = m_actors[k]->getID();
+		if ((id != IID_BULLET && id != IID_TORPEDO) || m_actors[k]->isDead())
+			continue;
+		Projectile* p = static_cast<Projectile*>(m_actors[k]);
+		if (!(p->playerFired()))
+			continue;
+		getCollidingAliens(p, aliens, checks);
+		for (int i = 0; i < aliens.size(); i++)
+			aliens[i]->damage(p->getDamage(), true);
+		if (!aliens.empty())
+			p->setDead();
+	}
+
+	// Alien projectiles, then goodies, against each ship in turn; the first
+	// ship met takes the hit or gets the goodie.  An alien projectile also
+	// hits a ship that ends the tick in the cell the projectile started in,
+	// as it did when projectiles checked for the player before moving: one
+	// fired point-blank moves off the ship in the tick it appears, and one
+	// on the bottom row leaves the board, dead, as it goes.
+	for (int k = 0; k < numActors; k++)
+	{
+		int id = m_actors[k]->getID();
+		bool isProjectile = (id == IID_BULLET || id == IID_TORPEDO);
+		if (!isProjectile || static_cast<Projectile*>(m_actors[k])->playerFired())
+			continue;
+		Projectile* proj = static_cast<Projectile*>(m_actors[k]);
+		if (proj->isDead() && onBoard(proj))
+			continue;
+		bool hit = false;
+		for (int p = 0; p < MAX_PLAYERS && !hit; p++)
+		{
+			if (players[p] == NULL || players[p]->isDead())
+				continue;
+			checks++;
+			hit = collided(proj, players[p]) ||
+			      (proj->getTickStartX() == players[p]->getX() && proj->getTickStartY() == players[p]->getY());
+			if (hit)
+			{
+				players[p]->damage(proj->getDamage(), true);
+				proj->setDead();
+			}
+		}
+	}
+	for (int k = 0; k < numActors; k++)
+	{
+		int id = m_actors[k]->getID();
+		if ((id != IID_FREE_SHIP_GOODIE && id != IID_ENERGY_GOODIE && id != IID_TORPEDO_GOODIE) ||
+		    m_actors[k]->isDead())
+			continue;
+		for (int p = 0; p < MAX_PLAYERS && !(m_actors[k]->isDead()); p++)
+		{
+			if (players[p] == NULL || players[p]->isDead())
+				continue;
+			checks++;
+			if (collided(m_actors[k], players[p]))
+				static_cast<Goodie*>(m_actors[k])->doSpecialAction(players[p]);
+		}
+	}
+	metricsAdd(getMetrics(), METRIC_COLLISION_CHECKS, checks);
+}
+
+// Compute this tick's summary: ship locations, round-derived odds and
+// quotas, and what the alien projectile scan would return now
+void StudentWorld::computeSummary()
+{
+	getPlayerLocation(m_summary.playerX[0], m_summary.playerY[0]);
+	m_summary.numPlayers = 1;
+	if (m_player2 != NULL)
+	{
+		m_summary.playerX[1] = m_player2->getX();
+		m_summary.playerY[1] = m_player2->getY();
+		m_summary.numPlayers = 2;
+	}
+	m_summary.round = getRound();
+	RoundParams params = roundParams(m_summary.round);
+	m_summary.nachlingFireChance = params.nachlingFireChance;
+	m_summary.smallbotTorpedoChance = params.smallbotTorpedoChance;
+	m_summary.alienProjectileQuota = params.alienProjectileQuota;
+
+	int alienProjectiles = 0;
 	for (int k = 0; k < m_actors.size(); k++)
 	{
-		// Count the number of projectiles on the screen
-		Projectile *p = dynamic_cast<Projectile*>(m_actors[k]);
-		// If the projectile was not fired by a player, then increase the count
-		if (p != NULL && !(p->playerFired()))
-			num++;
+		int id = m_actors[k]->getID();
+		if ((id == IID_BULLET || id == IID_TORPEDO) && !(static_cast<Projectile*>(m_actors[k])->playerFired()))
+			alienProjectiles++;
 	}
-	return num;
+	m_summary.projectileBudget.store(m_summary.alienProjectileQuota - alienProjectiles);
 }
 
-// Get a pointer to the player if the actor collided with it
-Player* StudentWorld::getCollidingPlayer(Actor* a)
+// Get this tick's summary
+const WorldSummary& StudentWorld::getSummary() const
 {
-	if (a->getX() == m_player->getX() && a->getY() == m_player->getY())
-		return m_player;
-	// Otherwise return null
-	return NULL;
+	return m_summary;
+}
+
+// Take one alien projectile from this tick's budget, if any is left
+bool StudentWorld::tryConsumeAlienProjectile()
+{
+	int budget = m_summary.projectileBudget.load();
+	while (budget > 0)
+	{
+		if (m_summary.projectileBudget.compare_exchange_weak(budget, budget - 1))
+			return true;
+	}
+	return false;
+}
+
+// Take one alien projectile from the budget even if it is used up
+void StudentWorld::consumeAlienProjectile()
+{
+	m_summary.projectileBudget.fetch_sub(1);
 }
 
 // Remove all dead actors
 void StudentWorld::removeDeadActors()
 {
+	// Delete dead actors and slide the living ones down in their update order.
+	// (Erasing in place skipped the actor after each one erased, so two dead
+	// actors in a row left the second in the vector for another tick.)
+	int kept = 0;
 	for (int k = 0; k < m_actors.size(); k++)
 	{
-		// For each actor in the vector, if they are dead, remove them and delete them
 		if (m_actors[k]->isDead())
-		{
-			// Find the actor that has died and set an iterator to it
-			std::vector<Actor*>::iterator iter = find(m_actors.begin(), m_actors.end(), m_actors[k]);
-			// If the the find function did not yield end
-			if (iter != m_actors.end())
-			{
-				// Delete the actor and erase the node
-				Actor* temp = m_actors[k];
-				m_actors.erase(iter);
-				delete temp;
-			}
-		}
+			delete m_actors[k];
+		else
+			m_actors[kept++] = m_actors[k];
 	}
+	m_actors.resize(kept);
 }
 
 void StudentWorld::setDisplayText()
 {
+	// Nobody sees the text when running headless, so skip building it
+	if (isHeadless())
+		return;
 	int score = getScore();        // The current score
 	int round = getRound();        // The current round
 	double energyPercent = m_player->getEnergyPct()*100;   // Get the percentage of energy and multiply by 100
@@ -202,4 +527,179 @@ void StudentWorld::setDisplayText()
 		+ " Torpedoes:"+otorpedoes.str() + "  Ships: "+oships.str();
 	// Finally,update the display text at the top of the screen with your stats
 	setGameStatText(s);  // calls GameWorld::setGameStatText
-}
\ No newline at end of file
+}
+
+// Write the world: header, round progress, the player, every other actor
+// in update order, the stars, and last lives/score/random state.  Debris
+// and the per-tick summary are left out: neither affects what happens next.
+void StudentWorld::saveState(SnapshotWriter& w) const
+{
+	w.putInt(SNAPSHOT_MAGIC);
+	w.putInt(SNAPSHOT_VERSION);
+	w.putInt(m_round);
+	w.putInt(m_numDead);
+	w.putBool(m_player != NULL);
+	if (m_player != NULL)
+		m_player->saveState(w);
+	w.putBool(m_twoPlayers);
+	w.putBool(m_player2 != NULL);
+	if (m_player2 != NULL)
+		m_player2->saveState(w);
+	w.putInt(int(m_actors.size()));
+	for (int k = 0; k < m_actors.size(); k++)
+	{
+		w.putInt(m_actors[k]->getID());
+		m_actors[k]->saveState(w);
+	}
+	w.putUnsigned(m_nextSerial);
+	m_stars.saveState(w);
+	saveWorldState(w);
+}
+
+// Read a world written by saveState.  On bad data the world is left empty
+// (as after cleanUp) and false is returned.
+bool StudentWorld::loadState(SnapshotReader& r)
+{
+	cleanUp();
+	if (r.getInt() != SNAPSHOT_MAGIC || r.getInt() != SNAPSHOT_VERSION)
+		return false;
+	m_round = r.getInt();
+	m_numDead = r.getInt();
+	if (m_round <= 0)   // round divides several odds
+		r.fail();
+	if (r.getBool() && r.ok())
+	{
+		m_player = new Player(this);
+		m_player->loadState(r);
+	}
+	m_twoPlayers = r.getBool();
+	if (r.getBool() && r.ok())
+	{
+		m_player2 = new Player(this, 1);
+		m_player2->loadState(r);
+	}
+	  // Actors add themselves to m_actors as they are constructed, so
+	  // creating them in saved order restores the update order
+	int numActors = r.getCount(VIEW_WIDTH * VIEW_HEIGHT * 4);
+	for (int k = 0; k < numActors && r.ok(); k++)
+	{
+		Actor* a = createActor(r.getInt());
+		if (a == NULL)
+		{
+			r.fail();
+			break;
+		}
+		a->loadState(r);
+	}
+	m_nextSerial = r.getUnsigned();   // After the actors, whose constructors take serials
+	m_stars.loadState(r);
+	  // Read last, because the constructors above draw random numbers
+	loadWorldState(r);
+	if (!r.ok() || !r.atEnd())
+	{
+		cleanUp();
+		return false;
+	}
+	return true;
+}
+
+// Create an actor of the given type, to be overwritten by loadState
+Actor* StudentWorld::createActor(int imageID)
+{
+	switch (imageID)
+	{
+		case IID_NACHLING:          return new Nachling(this, m_round);
+		case IID_WEALTHY_NACHLING:  return new WealthyNachling(this, m_round);
+		case IID_SMALLBOT:          return new Smallbot(this, m_round);
+		case IID_BULLET:            return new Bullet(this, 0, 0, false);
+		case IID_TORPEDO:           return new Torpedo(this, 0, 0, false);
+		case IID_FREE_SHIP_GOODIE:  return new FreeShipGoodie(this, 0, 0);
+		case IID_ENERGY_GOODIE:     return new EnergyGoodie(this, 0, 0);
+		case IID_TORPEDO_GOODIE:    return new TorpedoGoodie(this, 0, 0);
+	}
+	return NULL;
+}
+
+// Check what must hold between ticks.  The message is only built once
+// something fails, so the cheap checks cost one pass over the actors.
+bool StudentWorld::checkInvariants(bool thorough, std::string& problem) const
+{
+	const Player* players[MAX_PLAYERS] = { m_player, m_player2 };
+	int expectedLive = int(m_actors.size()) + (m_player != NULL ? 1 : 0) + (m_player2 != NULL ? 1 : 0);
+	if (m_liveActors != expectedLive)
+	{
+		std::ostringstream oss;
+		oss << m_liveActors << " actors alive but " << expectedLive << " owned by the world (leak or double delete)";
+		problem = oss.str();
+		return false;
+	}
+	if (m_round < 1 || m_numDead < 0 || m_numDead >= 4*m_round)
+	{
+		std::ostringstream oss;
+		oss << m_numDead << " aliens dead in round " << m_round << ", which needs " << 4*m_round;
+		problem = oss.str();
+		return false;
+	}
+	if (m_player2 != NULL && (m_player == NULL || !m_twoPlayers))
+	{
+		problem = "second player without a first, or in a one-player game";
+		return false;
+	}
+	for (int p = 0; p < MAX_PLAYERS; p++)
+	{
+		const Player* player = players[p];
+		if (player == NULL)
+			continue;
+		bool badEnergy = !player->isDead() && (player->getEnergy() <= 0 || player->getEnergyPct() > 1);
+		if (!badEnergy && player->getNumTorpedoes() >= 0 && onBoard(player))
+			continue;
+		std::ostringstream oss;
+		if (badEnergy)
+			oss << "player " << p + 1 << " energy " << player->getEnergy() << " (" << player->getEnergyPct()*100 << "%)";
+		else if (player->getNumTorpedoes() < 0)
+			oss << "player " << p + 1 << " has " << player->getNumTorpedoes() << " torpedoes";
+		else
+			oss << "player " << p + 1 << " off the board at (" << player->getX() << "," << player->getY() << ")";
+		problem = oss.str();
+		return false;
+	}
+	for (int k = 0; k < m_actors.size(); k++)
+	{
+		const Actor* a = m_actors[k];
+		bool isPlayer = (a == m_player || a == m_player2);
+		if (!a->isDead() && onBoard(a) && !isPlayer)
+			continue;
+		std::ostringstream oss;
+		if (a->isDead())
+			oss << "dead actor (image " << a->getID() << ") still in m_actors";
+		else if (isPlayer)
+			oss << "player in m_actors";
+		else
+			oss << "actor (image " << a->getID() << ") off the board at (" << a->getX() << "," << a->getY() << ")";
+		problem = oss.str();
+		return false;
+	}
+	problem.clear();
+	if (!thorough)
+		return true;
+
+	std::vector<Actor*> sorted(m_actors);
+	std::sort(sorted.begin(), sorted.end());
+	if (std::adjacent_find(sorted.begin(), sorted.end()) != sorted.end())
+	{
+		problem = "actor in m_actors twice";
+		return false;
+	}
+	for (int k = 0; k < m_actors.size(); k++)
+	{
+		const Ship* ship = dynamic_cast<const Ship*>(m_actors[k]);
+		if (ship != NULL && (ship->getEnergyPct() > 1 || ship->getEnergyPct() <= 0))
+		{
+			std::ostringstream oss;
+			oss << "alien (image " << ship->getID() << ") energy " << ship->getEnergyPct()*100 << "%";
+			problem = oss.str();
+			return false;
+		}
+	}
+	return true;
+}
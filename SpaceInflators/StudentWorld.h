@@ -5,10 +5,48 @@
 #include "GameConstants.h"
 
 #include "actor.h"
+#include "StarField.h"
+#include "EffectPool.h"
+#include "ActorStats.h"
 #include <vector>
+#include <string>
+#include <atomic>
+#include <cstdlib>
 
 // Students:  Add code to this file, StudentWorld.cpp, actor.h, and actor.cpp
 
+// What the alien AI needs to know about the world, computed once per tick
+// after the player moves and before any other actor does.  Everything but
+// the projectile budget is read-only during the tick; the budget is atomic
+// so actors could safely be updated in parallel.
+struct WorldSummary
+{
+	int numPlayers;                  // ships in the game, each entry below valid
+	int playerX[MAX_PLAYERS];
+	int playerY[MAX_PLAYERS];
+	int round;
+	int nachlingFireChance;          // a Nachling fires with probability 1 in this
+	int smallbotTorpedoChance;       // a Smallbot fires a torpedo with probability 1 in this
+	int alienProjectileQuota;        // most alien projectiles allowed on screen
+	std::atomic<int> projectileBudget;   // quota left this tick (torpedoes can overdraw it)
+
+	  // The ship whose column is nearest x, the first player's on a tie
+	int nearestPlayer(int x) const
+	{
+		int nearest = 0;
+		for (int p = 1; p < numPlayers; p++)
+			if (std::abs(playerX[p] - x) < std::abs(playerX[nearest] - x))
+				nearest = p;
+		return nearest;
+	}
+};
+
+// How move() calls the actors' doSomething: through the vtable; through a
+// switch on the image ID, in the same order and so playing the same game;
+// or type by type with the actors grouped by image ID, which changes the
+// update order so a seeded game plays out differently
+enum DispatchMode { DISPATCH_VIRTUAL, DISPATCH_SWITCH, DISPATCH_GROUPED };
+
 class StudentWorld : public GameWorld
 {
 public:
@@ -16,41 +54,67 @@ public:
 	~StudentWorld();
 	void addActor(Actor* actor);   // Adds an actor to the vector
 	void addAliensOrStars();      // Adds an alien or a star
+	virtual const StarField* getStarField() const;   // The background stars
+	virtual const EffectPool* getEffects() const;    // Debris particles
+	void addEffect(EffectPool::Burst kind, Actor* a);   // Throw debris out of an actor's cell
+	const Player* getPlayer() const;   // The player, for observers outside the game
+	const Player* getSecondPlayer() const;   // The second player's ship, or NULL
+	void setTwoPlayers(bool twoPlayers);     // Whether init() makes a ship for a second player
+	const std::vector<Actor*>& getActors() const;   // Every actor but the player
 	void getPlayerLocation(int& x, int& y);  // Gets the Player's current location
 	int getRound() const;         // Gets the round number
-	int getNumAlienFiredProjectiles() const;    // Get the number of projectiles fired by aliens
-	std::vector<Alien*> getCollidingAliens(Actor* a);   // A list of aliens on the same coordinate the player
 	void increaseDead();          // Increases the number of dead aliens
-	Player* getCollidingPlayer(Actor* a);       // Get a pointer to Player if actor is at same location
+	int getTotalKills() const;    // Aliens killed since this world was created
 	void removeDeadActors();      // Removes dead actors
 	void setDisplayText();        // Sets the display at ttop of screen
+	const WorldSummary& getSummary() const;   // This tick's summary for alien AI
+	bool tryConsumeAlienProjectile();   // Take one projectile from the budget if any is left
+	void actorCreated(int imageID);    // Count an actor (the player included) as alive
+	void actorDestroyed(int imageID, long long ageTicks);   // Count an actor as deleted
+	long long getTick() const;    // Ticks this world has moved
+	unsigned int nextActorSerial();   // A serial number no other actor in this world has had
+	void setDispatchMode(DispatchMode mode);   // How move() calls doSomething
+	virtual const ActorStats* getActorStats() const;   // Allocations by actor type
+	// Check the world's consistency between ticks; on failure returns false
+	// and describes the first problem found.  The thorough checks cost more
+	// than a tick does; the cheap ones are a single pass over the actors.
+	bool checkInvariants(bool thorough, std::string& problem) const;
+	void saveState(SnapshotWriter& w) const;   // Write everything a later move() depends on
+	bool loadState(SnapshotReader& r);         // Replace this world with a saved one; false if the data is bad
+	void consumeAlienProjectile();      // Take one projectile from the budget unconditionally
 	// Initializes a StudentWorld
 	virtual void init()
     {
 		m_player = new Player(this);
+		if (m_twoPlayers)
+			m_player2 = new Player(this, 1);
     }
 	// Action each tick
 	virtual int move()
     {
+		m_tick++;              // Count the tick, for actor lifetimes
+		markTickStart();       // Remember where everyone starts, for the collision phase
 		addAliensOrStars();    // Attempt to add an alien or a star
 		setDisplayText();      // Set the display text
 		m_player->doSomething();   // Make the player do something
+		if (m_player2 != NULL)
+			m_player2->doSomething();   // and the second player, if there is one
+		computeSummary();          // Snapshot what the aliens need this tick
 
-		for (int k = 0; k < m_actors.size(); k++)
-		{
-			// If actor is still alive, make each actor in the vector do something
-			if (!(m_actors[k]->isDead()))
-				m_actors[k]->doSomething();
-		}
+		updateActors();            // Make each living actor do something
+		resolveCollisions();       // Settle everything that met this tick
 		removeDeadActors();    // Remove dead actors
+		m_stars.scroll();      // Scroll the stars down and drop those off the board
+		m_effects.step();      // Move and age the debris
+		updateActorMetrics();  // Publish actor counts if metrics are on
 		// If the number of dead aliens equals the goal, increase the round and reset dead
 		if (m_numDead == 4*getRound())
 		{
 			m_round++;
 			m_numDead = 0;
 		}
-		// If player is dead, decrease lives, reset round, and return that the player has died
-		if (m_player->isDead())
+		// If either player is dead, decrease the shared lives, reset round, and return that the player has died
+		if (m_player->isDead() || (m_player2 != NULL && m_player2->isDead()))
 		{
 			decLives();
 			m_numDead = 0;
@@ -62,6 +126,9 @@ public:
 	virtual void cleanUp()
     {
 		delete m_player;   // Delete the player
+		m_player = NULL;
+		delete m_player2;
+		m_player2 = NULL;
 		std::vector<Actor*>::iterator iter = m_actors.end();
 		// Delete all the actors in the vector
 		while (iter != m_actors.begin())
@@ -72,13 +139,42 @@ public:
 		// Empty the vector
 		while (!m_actors.empty())
 			m_actors.pop_back();
+		m_stars.clear();   // Remove all stars
+		m_effects.clear(); // Remove all debris
 	}
 
 private:
+	void computeSummary();
+	void updateActors();
+	void markTickStart();
+	void resolveCollisions();
+	void indexAliens();
+	void getCollidingAliens(const Actor* a, std::vector<Alien*>& aliens, long long& checks) const;
+	static bool collided(const Actor* a, const Actor* b);
+	void updateActorMetrics();
+	Actor* createActor(int imageID);   // A default actor of the given type, for loadState
+	static bool onBoard(const Actor* a)
+	{
+		return a->getX() >= 0 && a->getX() < VIEW_WIDTH && a->getY() >= 0 && a->getY() < VIEW_HEIGHT;
+	}
 	std::vector<Actor*> m_actors;   // Vector of pointers to actors
 	Player* m_player;          // Pointer to the player
+	Player* m_player2;         // The second player's ship, if there are two
+	bool m_twoPlayers;         // Whether init() makes m_player2
 	int m_round;               // The current round number
 	int m_numDead;             // Current total of dead aliens
+	int m_totalKills;          // Dead aliens over every round, for statistics
+	int m_liveActors;          // Actors constructed and not yet deleted, the player included
+	long long m_tick;          // Ticks moved so far
+	unsigned int m_nextSerial; // Serial number for the next actor made
+	ActorStats m_actorStats;   // Allocations and lifetimes by actor type
+	DispatchMode m_dispatch;   // How updateActors calls doSomething
+	std::vector<int> m_typeOrder;   // Scratch for DISPATCH_GROUPED: actor indices by type
+	std::vector<int> m_cellFirst;   // Per cell, index of the first living alien there, or -1
+	std::vector<int> m_cellNext;    // Per actor, index of the next alien in its cell, or -1
+	WorldSummary m_summary;    // This tick's summary for alien AI
+	StarField m_stars;         // Background stars
+	EffectPool m_effects;      // Debris from hits and deaths
 };
 
 #endif // _GAMEWORLD_H_
@@ -0,0 +1,211 @@
+#include "Telemetry.h"
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+using namespace std;
+
+// LatencyHistogram
+
+LatencyHistogram::LatencyHistogram()
+{
+	reset();
+}
+
+void LatencyHistogram::reset()
+{
+	for (int k = 0; k < NUM_BUCKETS; k++)
+		m_counts[k] = 0;
+	m_count = m_total = m_min = m_max = 0;
+}
+
+int LatencyHistogram::bucketFor(long long us)
+{
+	if (us < LINEAR_BUCKETS)
+		return us < 0 ? 0 : int(us);
+	int msb = 0;
+	for (unsigned long long v = us; v > 1; v >>= 1)
+		msb++;
+	int range = msb - 4;
+	int sub = int(us >> (msb - 3)) - SUB_BUCKETS;
+	int bucket = LINEAR_BUCKETS + range * SUB_BUCKETS + sub;
+	return bucket < NUM_BUCKETS ? bucket : NUM_BUCKETS - 1;
+}
+
+long long LatencyHistogram::bucketLowerBound(int bucket)
+{
+	if (bucket < LINEAR_BUCKETS)
+		return bucket;
+	int range = (bucket - LINEAR_BUCKETS) / SUB_BUCKETS;
+	int sub = (bucket - LINEAR_BUCKETS) % SUB_BUCKETS;
+	return (long long)(SUB_BUCKETS + sub) << (range + 1);
+}
+
+void LatencyHistogram::record(long long us)
+{
+	if (us < 0)
+		us = 0;
+	m_counts[bucketFor(us)]++;
+	if (m_count == 0 || us < m_min)
+		m_min = us;
+	if (us > m_max)
+		m_max = us;
+	m_count++;
+	m_total += us;
+}
+
+void LatencyHistogram::recordBucket(int bucket, long long count)
+{
+	if (count <= 0)
+		return;
+	long long low = bucketLowerBound(bucket);
+	long long high = bucket+1 < NUM_BUCKETS ? bucketLowerBound(bucket+1) - 1 : low;
+	m_counts[bucket] += count;
+	if (m_count == 0 || low < m_min)
+		m_min = low;
+	if (high > m_max)
+		m_max = high;
+	m_count += count;
+	m_total += low * count;
+}
+
+long long LatencyHistogram::getPercentile(double pct) const
+{
+	if (m_count == 0)
+		return 0;
+	long long target = (long long)(pct / 100 * m_count + 0.5);
+	if (target < 1)
+		target = 1;
+	long long seen = 0;
+	for (int k = 0; k < NUM_BUCKETS; k++)
+	{
+		seen += m_counts[k];
+		if (seen >= target)
+		{
+			  // Report the highest value the bucket can hold, like HdrHistogram
+			long long upper = k+1 < NUM_BUCKETS ? bucketLowerBound(k+1) - 1 : m_max;
+			return upper < m_max ? upper : m_max;
+		}
+	}
+	return m_max;
+}
+
+long long LatencyHistogram::getCountAbove(long long us) const
+{
+	long long n = 0;
+	for (int k = bucketFor(us) + 1; k < NUM_BUCKETS; k++)
+		n += m_counts[k];
+	return n;
+}
+
+void LatencyHistogram::writeSummary(ostream& os, const string& name) const
+{
+	ios_base::fmtflags flags = os.flags();
+	streamsize precision = os.precision();
+	os << "  " << left << setw(18) << name << right
+	   << " n=" << setw(7) << m_count
+	   << "  mean=" << setw(7) << fixed << setprecision(0) << getMean()
+	   << "  p50=" << setw(6) << getPercentile(50)
+	   << "  p90=" << setw(6) << getPercentile(90)
+	   << "  p99=" << setw(6) << getPercentile(99)
+	   << "  p99.9=" << setw(6) << getPercentile(99.9)
+	   << "  max=" << setw(7) << getMax() << "  (us)" << endl;
+	os.flags(flags);
+	os.precision(precision);
+}
+
+// Telemetry
+
+Telemetry::Telemetry()
+ : m_targetFrameMs(0), m_startTime(0), m_lastTimerCallback(0), m_lastFramePresented(0),
+   m_firstFramePresented(0), m_firstPromptDismissed(0), m_firstMove(0)
+{
+}
+
+long long Telemetry::now()
+{
+	return chrono::duration_cast<chrono::microseconds>(
+		chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+void Telemetry::start(int targetFrameMs)
+{
+	m_targetFrameMs = targetFrameMs;
+	m_startTime = now();
+	atexit(writeSummaryAtExit);
+}
+
+void Telemetry::markTimerCallback()
+{
+	long long t = now();
+	if (m_lastTimerCallback != 0)
+		m_timerIntervals.record(t - m_lastTimerCallback);
+	m_lastTimerCallback = t;
+}
+
+void Telemetry::markFramePresented()
+{
+	long long t = now();
+	if (m_lastFramePresented != 0)
+		m_frameIntervals.record(t - m_lastFramePresented);
+	if (m_firstFramePresented == 0)
+		m_firstFramePresented = t;
+	m_lastFramePresented = t;
+}
+
+void Telemetry::markPromptPresented()
+{
+	if (m_firstFramePresented == 0)
+		m_firstFramePresented = now();
+}
+
+void Telemetry::markPromptDismissed()
+{
+	if (m_firstPromptDismissed == 0)
+		m_firstPromptDismissed = now();
+}
+
+void Telemetry::recordSpan(Span span, long long startUs)
+{
+	if (span == SPAN_MOVE && m_firstMove == 0)
+		m_firstMove = startUs;
+	m_spans[span].record(now() - startUs);
+}
+
+void Telemetry::writeSummary(ostream& os) const
+{
+	  // Printed to cout between other output, so leave its format as found
+	ios_base::fmtflags flags = os.flags();
+	streamsize precision = os.precision();
+	double seconds = (now() - m_startTime) / 1e6;
+	long long target = m_targetFrameMs * 1000LL;
+
+	os << "Frame telemetry over " << fixed << setprecision(1) << seconds << " s" << endl;
+	if (m_timerIntervals.getCount() > 0)
+	{
+		double rate = 1e6 / m_timerIntervals.getMean();
+		os << "  timer target " << m_targetFrameMs << " ms (" << 1000 / m_targetFrameMs << " Hz), achieved "
+		   << setprecision(1) << rate << " Hz; " << m_timerIntervals.getCountAbove(target + target/2)
+		   << " callbacks more than 50% late" << endl;
+	}
+	if (m_firstFramePresented != 0)
+		os << "  first frame " << setprecision(1) << (m_firstFramePresented - m_startTime) / 1000.0 << " ms after start";
+	if (m_firstMove != 0 && m_firstPromptDismissed != 0)
+		os << (m_firstFramePresented != 0 ? ", first tick " : "  first tick ") << setprecision(1)
+		   << (m_firstMove - m_firstPromptDismissed) / 1000.0 << " ms after the welcome prompt was dismissed";
+	if (m_firstFramePresented != 0 || (m_firstMove != 0 && m_firstPromptDismissed != 0))
+		os << endl;
+	m_timerIntervals.writeSummary(os, "timer interval");
+	m_frameIntervals.writeSummary(os, "frame interval");
+	m_spans[SPAN_MOVE].writeSummary(os, "move()");
+	m_spans[SPAN_DISPLAY].writeSummary(os, "displayGamePlay()");
+	m_spans[SPAN_SWAP].writeSummary(os, "glutSwapBuffers()");
+	m_spans[SPAN_INPUT_TO_MOVE].writeSummary(os, "input to moveTo");
+	m_spans[SPAN_INPUT_TO_DISPLAY].writeSummary(os, "input to display");
+	os.flags(flags);
+	os.precision(precision);
+}
+
+void Telemetry::writeSummaryAtExit()
+{
+	getInstance().writeSummary(cout);
+}
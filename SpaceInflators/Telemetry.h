@@ -0,0 +1,134 @@
+#ifndef _TELEMETRY_H_
+#define _TELEMETRY_H_
+
+#include <iostream>
+#include <string>
+
+// Log-linear histogram of microsecond durations in the style of HdrHistogram:
+// every power-of-two range is split into 8 linear sub-buckets, so any
+// recorded value is reported within 1/8 (12.5%) of its true value.
+class LatencyHistogram
+{
+  public:
+	LatencyHistogram();
+
+	void record(long long us);
+	void reset();
+
+	long long getCount() const
+	{
+		return m_count;
+	}
+
+	long long getMin() const
+	{
+		return m_count > 0 ? m_min : 0;
+	}
+
+	long long getMax() const
+	{
+		return m_max;
+	}
+
+	double getMean() const
+	{
+		return m_count > 0 ? double(m_total) / m_count : 0;
+	}
+
+	long long getPercentile(double pct) const;   // pct in [0, 100]
+	long long getCountAbove(long long us) const;
+
+	void writeSummary(std::ostream& os, const std::string& name) const;
+
+	  // For recorders that keep their own (e.g. atomic) bucket counts and
+	  // merge them here later.  Merged values count as their bucket's bounds.
+	static const int LINEAR_BUCKETS = 16;   // values 0..15 are exact
+	static const int SUB_BUCKETS    = 8;
+	static const int NUM_BUCKETS    = LINEAR_BUCKETS + 48 * SUB_BUCKETS;
+
+	static int bucketFor(long long us);
+	static long long bucketLowerBound(int bucket);
+	void recordBucket(int bucket, long long count);
+
+  private:
+
+	long long m_counts[NUM_BUCKETS];
+	long long m_count;
+	long long m_total;
+	long long m_min;
+	long long m_max;
+};
+
+// Timing of the GLUT main loop: when timer callbacks fire, how long move(),
+// drawing and glutSwapBuffers() take, the interval between presented
+// frames, and how long a key press takes to reach the player's position
+// (SPAN_INPUT_TO_MOVE) and the screen (SPAN_INPUT_TO_DISPLAY), how long
+// after start() the first frame of any kind (usually the welcome prompt)
+// was presented, and how long after the welcome prompt was dismissed the
+// first tick came.  A summary is printed when the program exits.
+class Telemetry
+{
+  public:
+	enum Span {
+		SPAN_MOVE, SPAN_DISPLAY, SPAN_SWAP, SPAN_INPUT_TO_MOVE, SPAN_INPUT_TO_DISPLAY,
+		NUM_SPANS
+	};
+
+	static long long now();   // microseconds on a monotonic clock
+
+	void start(int targetFrameMs);
+	void markTimerCallback();
+	void markFramePresented();          // a gameplay frame
+	void markPromptPresented();         // a prompt screen, which only counts as a first frame
+	void markPromptDismissed();         // only the first call counts
+	void recordSpan(Span span, long long startUs);
+
+	const LatencyHistogram& getTimerIntervals() const
+	{
+		return m_timerIntervals;
+	}
+
+	const LatencyHistogram& getFrameIntervals() const
+	{
+		return m_frameIntervals;
+	}
+
+	const LatencyHistogram& getSpan(Span span) const
+	{
+		return m_spans[span];
+	}
+
+	void writeSummary(std::ostream& os) const;
+
+	  // Meyers singleton pattern
+	static Telemetry& getInstance()
+	{
+		static Telemetry instance;
+		return instance;
+	}
+
+  private:
+	Telemetry();
+	Telemetry(const Telemetry&);
+	Telemetry& operator=(const Telemetry&);
+
+	static void writeSummaryAtExit();
+
+	int              m_targetFrameMs;
+	long long        m_startTime;
+	long long        m_lastTimerCallback;
+	long long        m_lastFramePresented;
+	long long        m_firstFramePresented;
+	long long        m_firstPromptDismissed;
+	long long        m_firstMove;
+	LatencyHistogram m_timerIntervals;
+	LatencyHistogram m_frameIntervals;
+	LatencyHistogram m_spans[NUM_SPANS];
+};
+
+inline Telemetry& Telem()
+{
+	return Telemetry::getInstance();
+}
+
+#endif // _TELEMETRY_H_
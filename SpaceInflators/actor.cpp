@@ -1,5 +1,9 @@
 #include "actor.h"
 #include "StudentWorld.h"
+#include "Snapshot.h"
+#include "ActorStats.h"
+#include "RoundParams.h"
+#include <new>
 
 // Students:  Add code to this file (if you wish), actor.h, StudentWorld.h, and StudentWorld.cpp
 
@@ -9,7 +13,53 @@ Actor::Actor(StudentWorld* world, int imageID, int startX, int startY) : GraphOb
 	m_world = world;  // Set the StudentWorld
 	m_dead = false;   // Set death state to false
 	m_ticks = 0;      // Initialize ticks to 0
+	m_bornTick = m_world->getTick();
+	m_serial = m_world->nextActorSerial();
+	m_tickStartX = startX;   // A new actor starts its first tick where it appears
+	m_tickStartY = startY;
 	setVisible(true);  // Make the object visible
+	m_world->actorCreated(imageID);   // Let the world count its live actors
+}
+
+// Destruct an Actor
+Actor::~Actor()
+{
+	m_world->actorDestroyed(getID(), m_world->getTick() - m_bornTick);
+}
+
+// Size of the concrete class drawn with an image ID
+std::size_t Actor::sizeOf(int imageID)
+{
+	switch (imageID)
+	{
+		case IID_PLAYER_SHIP:       return sizeof(Player);
+		case IID_NACHLING:          return sizeof(Nachling);
+		case IID_WEALTHY_NACHLING:  return sizeof(WealthyNachling);
+		case IID_SMALLBOT:          return sizeof(Smallbot);
+		case IID_BULLET:            return sizeof(Bullet);
+		case IID_TORPEDO:           return sizeof(Torpedo);
+		case IID_FREE_SHIP_GOODIE:  return sizeof(FreeShipGoodie);
+		case IID_ENERGY_GOODIE:     return sizeof(EnergyGoodie);
+		case IID_TORPEDO_GOODIE:    return sizeof(TorpedoGoodie);
+		default:                    return 0;
+	}
+}
+
+// Allocate any actor, counting the bytes
+void* Actor::operator new(std::size_t size)
+{
+	void* p = ::operator new(size);
+	ActorStats::recordAlloc(size);
+	return p;
+}
+
+// Free any actor; the virtual destructor makes size that of the whole object
+void Actor::operator delete(void* p, std::size_t size)
+{
+	if (p == NULL)
+		return;
+	ActorStats::recordFree(size);
+	::operator delete(p);
 }
 
 // Get a pointer to the StudentWorld
@@ -30,29 +80,38 @@ bool Actor::isDead() const
 	return m_dead;
 }
 
-// Perform an action in given interval n
-int Actor::everyOtherTick(int n)
+// Record the cell the actor is in as where the current tick began
+void Actor::markTickStart()
 {
-	m_ticks++;      // Increase the number of ticks
-	if (m_ticks >= n)  // If ticks equals the given interval, reset to 0
-		m_ticks = 0;
-	return (m_ticks%n);   // Return the remainder of ticks divided by the interval
+	m_tickStartX = getX();
+	m_tickStartY = getY();
 }
 
-// Star's constructor
-Star::Star(StudentWorld* world) : Actor(world, IID_STAR, rand() % VIEW_WIDTH, VIEW_HEIGHT-1)
+// Get the column the actor was in when the tick began
+int Actor::getTickStartX() const
 {
-	getWorld()->addActor(this);   // Add to vector in StudentWorld
+	return m_tickStartX;
 }
 
-// Star's version of doSomething
-void Star::doSomething()
+// Get the row the actor was in when the tick began
+int Actor::getTickStartY() const
 {
-	// Move one unit down per tick
-	moveTo(getX(), getY()-1);
-	// If y is less than 0, set to dead
-	if (getY() < 0)
-		setDead();
+	return m_tickStartY;
+}
+
+// Get the actor's serial number
+unsigned int Actor::getSerial() const
+{
+	return m_serial;
+}
+
+// Perform an action in given interval n
+int Actor::everyOtherTick(int n)
+{
+	m_ticks++;      // Increase the number of ticks
+	if (m_ticks >= n)  // If ticks equals the given interval, reset to 0
+		m_ticks = 0;
+	return (m_ticks%n);   // Return the remainder of ticks divided by the interval
 }
 
 // Projectile's constructor
@@ -64,40 +123,30 @@ Projectile::Projectile(StudentWorld* world, int imageID, int startX, int startY,
 	getWorld()->addActor(this);    // Add to vector
 }
 
-// Projectile's doSomething
+// Projectile's doSomething.  What it hits is settled by the world's
+// collision phase once everything has moved.
 void Projectile::doSomething()
 {
-	// If player fired the projectile
 	if (playerFired())
-	{
-		moveTo(getX(),getY()+1);    // Move up every tick
-		std::vector<Alien*> aliens = getWorld()->getCollidingAliens(this);   // Get a vector of pointers to collided aliens
-		for (int k = 0; k < aliens.size(); k++)
-			aliens[k]->damage(m_damage, true);      // For each alien in vector, inflict damage
-		if (!aliens.empty())
-			setDead();              // Since the vector was not empty and aliens collided, set projectile as dead
-	}
-	// If alien fired projectile
-	else if (!playerFired())
-	{
-		Player* hit = getWorld()->getCollidingPlayer(this);   // Get a pointer to the player if collided
-		moveTo(getX(),getY()-1);    // Move down every tick
-		if (hit != NULL)
-		{
-			hit->damage(m_damage, true);   // Inflict damage on player, projectile set as true
-			setDead();              // Set the projectile as dead
-		}
-	}
+		moveTo(getX(),getY()+1);    // Move up every tick if player fired
+	else
+		moveTo(getX(),getY()-1);    // Move down every tick if alien fired
 	if (getY() < 0 || getY() >= VIEW_HEIGHT)   // If the projectile goes out of bounds, set as dead
 		setDead();
 }
 
 // Return whether or not player fired
-bool Projectile::playerFired()
+bool Projectile::playerFired() const
 {
 	return m_playerFired;
 }
 
+// Return the damage the projectile does
+int Projectile::getDamage() const
+{
+	return m_damage;
+}
+
 // Bullet's constructor
 Bullet::Bullet(StudentWorld* world, int startX, int startY, bool playerFired)
 	: Projectile(world, IID_BULLET, startX, startY, playerFired, 2)
@@ -115,26 +164,17 @@ Torpedo::Torpedo(StudentWorld* world, int startX, int startY, bool playerFired)
 // Goodie's constructor
 Goodie::Goodie(StudentWorld* world, int imageID, int startX, int startY) : Actor(world, imageID, startX, startY)
 {
-	m_goodieTickLifetime = m_ticksLeftToLive = int(100 / getWorld()->getRound()) + 30;  // Set the total and current lifetime to initial
+	m_goodieTickLifetime = m_ticksLeftToLive = roundParams(getWorld()->getRound()).goodieLifetime;  // Set the total and current lifetime to initial
 	getWorld()->addActor(this);   // Add to vector
 }
 
+// Goodie's doSomething; being picked up is handled by the collision phase
 void Goodie::doSomething()
 {
-	// If the goodie did not collide with the player
-	if (getWorld()->getCollidingPlayer(this) == NULL)
-	{
-		setBrightness(((double)m_ticksLeftToLive/(double)m_goodieTickLifetime) + 0.2);
-		m_ticksLeftToLive--;    // Decrease brightness per tick
-		if (everyOtherTick(3) == 0)
-		{
-			moveTo(getX(),getY()-1);  // Move down only every 3 ticks
-			if (getWorld()->getCollidingPlayer(this) != NULL)
-				doSpecialAction(getWorld()->getCollidingPlayer(this));    // Check if collided, and if so, do effect
-		}
-	}
-	else
-		doSpecialAction(getWorld()->getCollidingPlayer(this));    // If collided this tick, do effect
+	setBrightness(((double)m_ticksLeftToLive/(double)m_goodieTickLifetime) + 0.2);
+	m_ticksLeftToLive--;    // Decrease brightness per tick
+	if (everyOtherTick(3) == 0)
+		moveTo(getX(),getY()-1);  // Move down only every 3 ticks
 	if (m_ticksLeftToLive == 0 || getY() < 0)         // Set dead if current life becomes 0 or goes out of bounds
 		setDead();
 }
@@ -254,23 +294,19 @@ void Ship::launchProjectile(ProjectileType pt, bool playerFired)
 	}
 }
 
-// Player's constructor. Takes in a pointer to StudentWorld
-Player::Player(StudentWorld* world) : Ship(world, IID_PLAYER_SHIP, VIEW_WIDTH/2, 1, 50)
+// Player's constructor. Takes in a pointer to StudentWorld and which player
+// it is; the second player's ship starts to the right of the first
+Player::Player(StudentWorld* world, int slot)
+	: Ship(world, IID_PLAYER_SHIP, slot == 0 ? VIEW_WIDTH/2 : VIEW_WIDTH*3/4, 1, 50)
 {
 	m_torpedoes = 0;
 	m_fired = false;
+	m_slot = slot;
 }
 
-// Player's doSomething
+// Player's doSomething.  Ramming aliens is handled by the collision phase.
 void Player::doSomething()
 {
-	std::vector<Alien*> aliens = getWorld()->getCollidingAliens(this);
-	for (int k = 0; k < aliens.size(); k++)
-		// For each alien that collided with player, decrease by their remaining energy
-		aliens[k]->damage(aliens[k]->getEnergy(), false);
-	// Since there were aliens in the vector, decrease Player's energy by 15
-	if (!aliens.empty())
-		damage(15, false);
 	// If the Player's energy hits 0, return dead
 	if (getEnergy() <= 0)
 	{
@@ -280,10 +316,20 @@ void Player::doSomething()
 	if (everyOtherTick(2) == 0 && m_fired)
 		m_fired = false;
 	int ch;
-	// Get an input key
-	if (getWorld()->getKey(ch))
+	bool moved = false, shot = false;
+	// Take queued keys in order, applying at most one move and one shot per tick;
+	// a second move or shot stays queued for the next tick
+	while (getWorld()->peekKey(ch, m_slot))
 	{
-		// User hit a key this tick
+		bool isMove = (ch == KEY_PRESS_LEFT || ch == KEY_PRESS_RIGHT || ch == KEY_PRESS_UP || ch == KEY_PRESS_DOWN);
+		bool isShot = (ch == KEY_PRESS_SPACE || ch == KEY_PRESS_TAB);
+		if ((isMove && moved) || (isShot && shot))
+			break;
+		long long keyTime;
+		getWorld()->getKey(ch, keyTime, m_slot);
+		moved = moved || isMove;
+		shot = shot || isShot;
+		int oldX = getX(), oldY = getY();
 		switch (ch)
 		{
 			// Move to correct location if able
@@ -321,13 +367,10 @@ void Player::doSomething()
 				}
 				break;
 		}
+		// Report moves for input-to-display latency measurement
+		if (getX() != oldX || getY() != oldY)
+			getWorld()->inputApplied(keyTime);
 	}
-	// Check if collided with alien again
-	std::vector<Alien*> aliens2 = getWorld()->getCollidingAliens(this);
-	for (int p = 0; p < aliens2.size(); p++)
-		aliens2[p]->damage(aliens2[p]->getEnergy(), false);
-	if (!aliens2.empty())
-		damage(15, false);
 }
 
 // Player's damage function
@@ -338,12 +381,14 @@ void Player::damage(int points, bool hitByProjectile)
 	{
 		decreaseEnergy(points);
 		getWorld()->playSound(SOUND_PLAYER_HIT);
+		getWorld()->addEffect(EffectPool::BURST_PLAYER_HIT, this);
 	}
 	// If collided
 	else if (!hitByProjectile)
 	{
 		decreaseEnergy(points);
 		getWorld()->playSound(SOUND_ENEMY_PLAYER_COLLISION);
+		getWorld()->addEffect(EffectPool::BURST_PLAYER_HIT, this);
 	}
 	// If energy becomes 0, set dead and play death sound
 	if (getEnergy() <= 0)
@@ -367,7 +412,7 @@ void Player::addTorpedoes(int n)
 
 // Alien's constructor
 Alien::Alien(StudentWorld* world, int imageID, int startEnergy, int worth)
-	: Ship(world, imageID, rand() % 30, 39, startEnergy)
+	: Ship(world, imageID, world->randInt(30), 39, startEnergy)
 {
 	m_worth = worth;   // Alien's point value
 	getWorld()->addActor(this);   // Add to vector
@@ -376,7 +421,6 @@ Alien::Alien(StudentWorld* world, int imageID, int startEnergy, int worth)
 // Nachbergs' damage function
 void Alien::damage(int points, bool hitByProjectile)
 {
-	Player* player = getWorld()->getCollidingPlayer(this);   // Get a pointer to collided player (if available)
 	// If hit by a projectile
 	if (hitByProjectile)
 	{
@@ -386,18 +430,22 @@ void Alien::damage(int points, bool hitByProjectile)
 		{
 			getWorld()->increaseDead();   // Increase the number of dead aliens
 			getWorld()->playSound(SOUND_ENEMY_DIE);   // Play death sound
+			getWorld()->addEffect(EffectPool::BURST_ALIEN_DIE, this);   // Throw debris
 			getWorld()->increaseScore(m_worth);    // Increase score by worth
 			setDead();                    // Set as dead
 			// One in 3 chance of dropping a goodie
-			if (rand() % 3 == 0)
+			if (getWorld()->randInt(3) == 0)
 				maybeDropGoodie();
 		}
 		else
-			// Just play the hit sound if not dead
+		{
+			// Just play the hit sound and throw sparks if not dead
 			getWorld()->playSound(SOUND_ENEMY_HIT);
+			getWorld()->addEffect(EffectPool::BURST_ALIEN_HIT, this);
+		}
 	}
 	// If collided with player, decrease remaining energy and set as dead
-	else if (!hitByProjectile && player != NULL)
+	else
 	{
 		decreaseEnergy(getEnergy());
 		setDead();
@@ -422,6 +470,7 @@ NachlingBase::NachlingBase(StudentWorld* world, int imageID, int round, int wort
 {
 	m_state = 0;      // Set state to 0
 	HMR = HMD = MDB = 0;   // Set distance calculations to 0
+	m_dir = 0;        // No direction until state 1 picks one
 }
 
 // NachlingBase's doSomething
@@ -432,13 +481,14 @@ void NachlingBase::doSomething()
 		return;
 	else
 	{
-		int x, y;
-		// Get the player's location
-		getWorld()->getPlayerLocation(x,y);
+		const WorldSummary& world = getWorld()->getSummary();
+		// Get the location of the player nearest this column
+		int target = world.nearestPlayer(getX());
+		int x = world.playerX[target], y = world.playerY[target];
 		// Calculate the distance to left and right border
 		int leftBorder = getX(), rightBorder = 29 - getX();
-		// Calculate the chance of firing
-		int chancesOfFiring = int(10/(getWorld()->getRound())) + 1;
+		// Get the chance of firing
+		int chancesOfFiring = world.nachlingFireChance;
 		// Based on its state
 		switch(m_state)
 		{
@@ -447,7 +497,7 @@ void NachlingBase::doSomething()
 				if (x != getX())
 				{
 					// One in 3 chance of moving down
-					if (rand() % 3 != 0)
+					if (getWorld()->randInt(3) != 0)
 					{
 						moveTo(getX(),getY()-1);
 						// If move off screen or energy is 0, set dead
@@ -481,7 +531,7 @@ void NachlingBase::doSomething()
 					}
 					// If MDB is greater than 3, set HMD to a number between 1 and 3
 					if (MDB > 3)
-						HMD = (rand() % 3) + 1;
+						HMD = getWorld()->randInt(3) + 1;
 					else
 						// Else, set HMD to MDB
 						HMD = MDB;
@@ -518,13 +568,13 @@ void NachlingBase::doSomething()
 				else if (m_dir == 'R' && getX()+1 < VIEW_WIDTH)
 					moveTo(getX()+1,getY());
 				// Fire based on chance if the number of current bullets is smaller than the limit
-				if (rand() % chancesOfFiring == 0)
+				if (getWorld()->randInt(chancesOfFiring) == 0)
 				{
-					if (getWorld()->getNumAlienFiredProjectiles() < 2*(getWorld()->getRound()))
+					if (getWorld()->tryConsumeAlienProjectile())
 						fireProjectile(BULLET);
 				}
 				// One out of 20 chance, change to state 2
-				if (rand() % 20 == 0)
+				if (getWorld()->randInt(20) == 0)
 					m_state = 2;
 				break;
 			case 2:
@@ -551,7 +601,7 @@ void NachlingBase::doSomething()
 				else
 				{
 					// 50-50 chance move left or right
-					int k = rand() % 2;
+					int k = getWorld()->randInt(2);
 					if (k == 0)
 					{
 						m_dir = 'L';
@@ -574,14 +624,14 @@ void NachlingBase::doSomething()
 
 // Nachling's constructor
 Nachling::Nachling(StudentWorld* world, int round)
-	: NachlingBase(world, IID_NACHLING, int(5*(0.9+(0.1*(double)round))), 1000)
+	: NachlingBase(world, IID_NACHLING, roundParams(round).nachlingEnergy, 1000)
 {
 
 }
 
 // WealthNachling's constructor
 WealthyNachling::WealthyNachling(StudentWorld* world, int round)
-	: NachlingBase(world, IID_WEALTHY_NACHLING, int(8*(0.9+(0.1*(double)round))), 1200)
+	: NachlingBase(world, IID_WEALTHY_NACHLING, roundParams(round).wealthyNachlingEnergy, 1200)
 {
 	m_malfunction = false;    // Initally not malfunctioning
 }
@@ -597,7 +647,7 @@ void WealthyNachling::doSomething()
 		return;
 	}
 	// One out of 200 chance of malfunctioning
-	if (rand() % 200 == 0)
+	if (getWorld()->randInt(200) == 0)
 		m_malfunction = true;
 	// Otherwise do same behavior as a Nachling
 	NachlingBase::doSomething();
@@ -607,14 +657,14 @@ void WealthyNachling::doSomething()
 void WealthyNachling::maybeDropGoodie()
 {
 	// 50% chance that WealthyNachling will drop an EnergyGoodie or a TorpedoGoodie
-	if (rand() % 2 == 0)
+	if (getWorld()->randInt(2) == 0)
 		new EnergyGoodie(getWorld(), getX(), getY());
 	else
 		new TorpedoGoodie(getWorld(), getX(), getY());
 }
 
 // Smallbot's constructor
-Smallbot::Smallbot(StudentWorld* world, int round) : Alien(world, IID_SMALLBOT, int(12*(0.9+(0.1*(double)round))), 1500)
+Smallbot::Smallbot(StudentWorld* world, int round) : Alien(world, IID_SMALLBOT, roundParams(round).smallbotEnergy, 1500)
 {
 	m_hit = false;    // Set hit state to false
 }
@@ -630,7 +680,7 @@ void Smallbot::doSomething()
 	{
 		m_hit = false;
 		// One out of 3 chance of moving left or right
-		if (rand() % 3 == 0)
+		if (getWorld()->randInt(3) == 0)
 		{
 			if (getX() == 0)
 				moveTo(getX()+1,getY()-1);
@@ -638,7 +688,7 @@ void Smallbot::doSomething()
 				moveTo(getX()-1,getY()-1);
 			else
 			{
-				if (rand() % 2 == 0)
+				if (getWorld()->randInt(2) == 0)
 					moveTo(getX()+1,getY()-1);
 				else
 					moveTo(getX()-1,getY()-1);
@@ -651,18 +701,18 @@ void Smallbot::doSomething()
 	else
 		// If not hit, move down
 		moveTo(getX(),getY()-1);
-	int x, y;
-	// Get player's location
-	getWorld()->getPlayerLocation(x,y);
-	// If player at same x coordinate
-	if (x == getX())
+	const WorldSummary& world = getWorld()->getSummary();
+	// If a player is at the same x coordinate
+	if (world.playerX[world.nearestPlayer(getX())] == getX())
 	{
-		// Chance of firing a torpedo
-		int q = int(100.0/getWorld()->getRound()) + 1;
-		if (rand() % q == 0)
+		// Chance of firing a torpedo; it counts against the round limit but ignores it
+		if (getWorld()->randInt(world.smallbotTorpedoChance) == 0)
+		{
+			getWorld()->consumeAlienProjectile();
 			fireProjectile(TORPEDO);
+		}
 		// Otherwise fire bullets based on round limit
-		else if (getWorld()->getNumAlienFiredProjectiles() < 2*getWorld()->getRound())
+		else if (getWorld()->tryConsumeAlienProjectile())
 			fireProjectile(BULLET);
 	}
 	// If move off screen, set as dead
@@ -673,8 +723,6 @@ void Smallbot::doSomething()
 // Smallbot's damage function
 void Smallbot::damage(int points, bool hitByProjectile)
 {
-	// Get a pointer to player if collided
-	Player* player = getWorld()->getCollidingPlayer(this);
 	// If hit by a projectile
 	if (hitByProjectile)
 	{
@@ -685,18 +733,22 @@ void Smallbot::damage(int points, bool hitByProjectile)
 		{
 			getWorld()->increaseDead();  // Increase number of dead aliens
 			getWorld()->playSound(SOUND_ENEMY_DIE);   // Play sound
+			getWorld()->addEffect(EffectPool::BURST_ALIEN_DIE, this);   // Throw debris
 			getWorld()->increaseScore(1500);   // Increase score
 			setDead();             // Set as dead
 			// One out of 3 chance of dropping a goodie
-			if (rand() % 3 == 0)
+			if (getWorld()->randInt(3) == 0)
 				maybeDropGoodie();
 		}
 		else
-			// If still alive, play hit sound
+		{
+			// If still alive, play hit sound and throw sparks
 			getWorld()->playSound(SOUND_ENEMY_HIT);
+			getWorld()->addEffect(EffectPool::BURST_ALIEN_HIT, this);
+		}
 	}
 	// If collided with player, decrease by remaining energy and set dead
-	else if (!hitByProjectile && player != NULL)
+	else
 	{
 		decreaseEnergy(getEnergy());
 		setDead();
@@ -707,4 +759,164 @@ void Smallbot::damage(int points, bool hitByProjectile)
 void Smallbot::maybeDropGoodie()
 {
 	new FreeShipGoodie(getWorld(), getX(), getY());
-}
\ No newline at end of file
+}
+
+// Write the actor's position, death state and tick counter
+void Actor::saveState(SnapshotWriter& w) const
+{
+	w.putInt(getX());
+	w.putInt(getY());
+	w.putBool(isVisible());
+	w.putDouble(getBrightness());
+	w.putBool(m_dead);
+	w.putInt(m_ticks);
+	w.putUnsigned(m_serial);
+}
+
+// Read back the actor's state; it is drawn standing still until its next move
+void Actor::loadState(SnapshotReader& r)
+{
+	int x = r.getInt();
+	int y = r.getInt();
+	moveTo(x, y);
+	beginTick();
+	setVisible(r.getBool());
+	setBrightness(r.getDouble());
+	m_dead = r.getBool();
+	m_ticks = r.getInt();
+	m_serial = r.getUnsigned();
+}
+
+void Projectile::saveState(SnapshotWriter& w) const
+{
+	Actor::saveState(w);
+	w.putBool(m_playerFired);
+	w.putInt(m_damage);
+}
+
+void Projectile::loadState(SnapshotReader& r)
+{
+	Actor::loadState(r);
+	m_playerFired = r.getBool();
+	m_damage = r.getInt();
+}
+
+void Goodie::saveState(SnapshotWriter& w) const
+{
+	Actor::saveState(w);
+	w.putInt(m_ticksLeftToLive);
+	w.putInt(m_goodieTickLifetime);
+}
+
+void Goodie::loadState(SnapshotReader& r)
+{
+	Actor::loadState(r);
+	m_ticksLeftToLive = r.getInt();
+	m_goodieTickLifetime = r.getInt();
+	if (m_goodieTickLifetime <= 0)   // it is divided by
+		r.fail();
+}
+
+void Ship::saveState(SnapshotWriter& w) const
+{
+	Actor::saveState(w);
+	w.putInt(m_fullEnergy);
+	w.putInt(m_energy);
+}
+
+void Ship::loadState(SnapshotReader& r)
+{
+	Actor::loadState(r);
+	m_fullEnergy = r.getInt();
+	m_energy = r.getInt();
+	if (m_fullEnergy <= 0)   // it is divided by
+		r.fail();
+}
+
+void Player::saveState(SnapshotWriter& w) const
+{
+	Ship::saveState(w);
+	w.putInt(m_torpedoes);
+	w.putBool(m_fired);
+}
+
+void Player::loadState(SnapshotReader& r)
+{
+	Ship::loadState(r);
+	m_torpedoes = r.getInt();
+	m_fired = r.getBool();
+}
+
+void Alien::saveState(SnapshotWriter& w) const
+{
+	Ship::saveState(w);
+	w.putInt(m_worth);
+}
+
+void Alien::loadState(SnapshotReader& r)
+{
+	Ship::loadState(r);
+	m_worth = r.getInt();
+}
+
+void NachlingBase::saveState(SnapshotWriter& w) const
+{
+	Alien::saveState(w);
+	w.putInt(m_state);
+	w.putInt(MDB);
+	w.putInt(HMD);
+	w.putInt(HMR);
+	w.putInt(m_dir);
+}
+
+void NachlingBase::loadState(SnapshotReader& r)
+{
+	Alien::loadState(r);
+	m_state = r.getInt();
+	MDB = r.getInt();
+	HMD = r.getInt();
+	HMR = r.getInt();
+	m_dir = char(r.getInt());
+}
+
+void WealthyNachling::saveState(SnapshotWriter& w) const
+{
+	NachlingBase::saveState(w);
+	w.putBool(m_malfunction);
+}
+
+void WealthyNachling::loadState(SnapshotReader& r)
+{
+	NachlingBase::loadState(r);
+	m_malfunction = r.getBool();
+}
+
+void Smallbot::saveState(SnapshotWriter& w) const
+{
+	Alien::saveState(w);
+	w.putBool(m_hit);
+}
+
+void Smallbot::loadState(SnapshotReader& r)
+{
+	Alien::loadState(r);
+	m_hit = r.getBool();
+}
+
+// Dispatch doSomething on the image ID, which names the concrete class
+void doSomethingByType(Actor* a)
+{
+	switch (a->getID())
+	{
+		case IID_NACHLING:          static_cast<Nachling*>(a)->Nachling::doSomething();               break;
+		case IID_WEALTHY_NACHLING:  static_cast<WealthyNachling*>(a)->WealthyNachling::doSomething(); break;
+		case IID_SMALLBOT:          static_cast<Smallbot*>(a)->Smallbot::doSomething();               break;
+		case IID_BULLET:            static_cast<Bullet*>(a)->Bullet::doSomething();                   break;
+		case IID_TORPEDO:           static_cast<Torpedo*>(a)->Torpedo::doSomething();                 break;
+		case IID_FREE_SHIP_GOODIE:  static_cast<FreeShipGoodie*>(a)->FreeShipGoodie::doSomething();   break;
+		case IID_ENERGY_GOODIE:     static_cast<EnergyGoodie*>(a)->EnergyGoodie::doSomething();       break;
+		case IID_TORPEDO_GOODIE:    static_cast<TorpedoGoodie*>(a)->TorpedoGoodie::doSomething();     break;
+		case IID_PLAYER_SHIP:       static_cast<Player*>(a)->Player::doSomething();                   break;
+		default:                    a->doSomething();                                                 break;
+	}
+}
@@ -2,31 +2,40 @@
 #define _ACTOR_H_
 
 #include "GraphObject.h"
+#include <cstddef>
 
 class StudentWorld;
 class Player;
+class SnapshotWriter;
+class SnapshotReader;
 
 // Students:  Add code to this file, actor.cpp, StudentWorld.h, and StudentWorld.cpp
 class Actor : public GraphObject
 {
 public:
 	Actor(StudentWorld* world, int imageID, int startX, int startY);   // Constructor
+	virtual ~Actor();                 // Destructor
 	virtual void doSomething() = 0;   // Pure virutal doSomething function
 	StudentWorld* getWorld();         // Return a pointer to StudentWorld
 	void setDead();                   // Sets actor as dead
 	bool isDead() const;              // Returns an actor as dead or not
 	int everyOtherTick(int n);        // Used to perform an action within an interval
+	void markTickStart();             // Remember the current cell as where this tick began
+	int getTickStartX() const;        // Column the actor was in when the tick began
+	int getTickStartY() const;        // Row the actor was in when the tick began
+	unsigned int getSerial() const;   // Number unique to this actor within its world
+	virtual void saveState(SnapshotWriter& w) const;   // Write the actor's state to a snapshot
+	virtual void loadState(SnapshotReader& r);         // Read back what saveState wrote
+	static std::size_t sizeOf(int imageID);    // Size of the class with this image ID
+	static void* operator new(std::size_t size);   // Counts heap bytes for ActorStats
+	static void operator delete(void* p, std::size_t size);
 private:
 	StudentWorld* m_world;        // A pointer to StudentWorld
 	bool m_dead;                  // Returns true if dead
 	int m_ticks;                  // Counts the number of ticks in an interval
-};
-
-class Star : public Actor
-{
-public:
-	Star(StudentWorld* world);
-	virtual void doSomething();
+	long long m_bornTick;         // The world's tick when this actor was made
+	unsigned int m_serial;        // Identifies the actor to spectators
+	int m_tickStartX, m_tickStartY;   // Cell at the start of the tick, for collisions
 };
 
 class Projectile : public Actor
@@ -34,7 +43,10 @@ class Projectile : public Actor
 public:
 	Projectile(StudentWorld* world, int imageID, int startX, int startY, bool playerFired, int damagePoints);
 	virtual void doSomething();
-	bool playerFired();          // Was it fired by the Player?
+	bool playerFired() const;    // Was it fired by the Player?
+	int getDamage() const;       // Damage done to whatever it hits
+	virtual void saveState(SnapshotWriter& w) const;
+	virtual void loadState(SnapshotReader& r);
 private:
 	bool m_playerFired;          // Returns true if player fired
 	int m_damage;                // Damage of the projectile
@@ -58,6 +70,8 @@ public:
 	Goodie(StudentWorld* world, int imageID, int startX, int startY);
 	virtual void doSomething();
 	virtual void doSpecialAction(Player* p) = 0;    // Do something to the player
+	virtual void saveState(SnapshotWriter& w) const;
+	virtual void loadState(SnapshotReader& r);
 private:
 	int m_ticksLeftToLive;         // Ticks left until dead
 	int m_goodieTickLifetime;      // Total tick lifetime
@@ -94,6 +108,8 @@ public:
 	void decreaseEnergy(int points);  // Decrease energy by the points
 	void restoreFullEnergy();         // Restore energy to starting level
 	void launchProjectile(ProjectileType pt, bool playerFired);   // Launch a specified projectile either from player or alien
+	virtual void saveState(SnapshotWriter& w) const;
+	virtual void loadState(SnapshotReader& r);
 private:
 	int m_fullEnergy;       // Full energy capacity
 	int m_energy;           // Current energy
@@ -102,14 +118,17 @@ private:
 class Player : public Ship
 {
 public:
-	Player(StudentWorld* world);
+	Player(StudentWorld* world, int slot = 0);   // slot 1 is the second player's ship
 	virtual void doSomething();
 	void damage(int points, bool hitByProjectile);   // Inflict damaged based on hit by projectile or alien
 	int getNumTorpedoes() const;    // Number of torpedos Player has
 	void addTorpedoes(int n);       // Add torpedos to Player
+	virtual void saveState(SnapshotWriter& w) const;
+	virtual void loadState(SnapshotReader& r);
 private:
 	int m_torpedoes;          // Current number of torpedoes
 	bool m_fired;     // True if Player fired this turn
+	int m_slot;       // Which player's keys move this ship
 };
 
 class Alien : public Ship
@@ -119,6 +138,8 @@ public:
 	virtual void damage(int points, bool hitByProjectile);   // Inflict damaged based on hit by projectile or Player
 	virtual void maybeDropGoodie();            // Chance of dropping a goodie
 	void fireProjectile(ProjectileType pt);    // Fire a projectile of indicated type
+	virtual void saveState(SnapshotWriter& w) const;
+	virtual void loadState(SnapshotReader& r);
 private:
 	int m_worth;      // The point value of the alien
 };
@@ -128,6 +149,8 @@ class NachlingBase : public Alien
 public:
 	NachlingBase(StudentWorld* world, int imageID, int round, int worth);
 	virtual void doSomething();
+	virtual void saveState(SnapshotWriter& w) const;
+	virtual void loadState(SnapshotReader& r);
 private:
 	int m_state, MDB, HMD, HMR;    // m_state is the state of the Nachling. Rest used to calculate movement
 	char m_dir;                    // Direction Nachling is facing
@@ -145,6 +168,8 @@ public:
 	WealthyNachling(StudentWorld* world, int round);
 	virtual void doSomething();
 	virtual void maybeDropGoodie();      // Virtual function to calculate probablity of dropping a goodie
+	virtual void saveState(SnapshotWriter& w) const;
+	virtual void loadState(SnapshotReader& r);
 private:
 	bool m_malfunction;           // Returns true if malfunctioning
 };
@@ -156,8 +181,15 @@ public:
 	virtual void doSomething();
 	virtual void damage(int points, bool hitByProjectile);
 	virtual void maybeDropGoodie();
+	virtual void saveState(SnapshotWriter& w) const;
+	virtual void loadState(SnapshotReader& r);
 private:
 	bool m_hit;           // Returns true if hit this tick
 };
 
+// Call a's doSomething through a switch on its image ID rather than the
+// vtable.  Each case names the concrete class, so the call is direct and
+// can be inlined.
+void doSomethingByType(Actor* a);
+
 #endif // _ACTOR_H_
\ No newline at end of file
@@ -6,6 +6,9 @@
 
 #include "GameController.h"
 #include "GameConstants.h"
+#include "Headless.h"
+#include "Metrics.h"
+#include "ActorStats.h"
 #include <cstdlib>
 #include <ctime>
 using namespace std;
@@ -16,6 +19,12 @@ GameWorld* createStudentWorld();
 
 int main(int argc, char* argv[])
 {
+	metricsInit(&argc, argv);
+	ActorStats::enableReportAtExit(&argc, argv);
+	int headlessResult = runHeadless(argc, argv);
+	if (headlessResult >= 0)
+		return headlessResult;
+
 	glutInit(&argc, argv);
 
     int testParams[NUM_TEST_PARAMS];